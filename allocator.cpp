@@ -0,0 +1,13 @@
+#include "allocator.hpp"
+
+std::unique_ptr<Allocator> createAllocator(const std::string& type, size_t mem_size) {
+    if (type == "first_fit")
+        return std::make_unique<FirstFit>();
+    if (type == "best_fit")
+        return std::make_unique<BestFit>();
+    if (type == "worst_fit")
+        return std::make_unique<WorstFit>();
+    if (type == "buddy")
+        return std::make_unique<BuddyAllocator>(mem_size);
+    return nullptr;
+}
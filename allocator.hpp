@@ -3,37 +3,68 @@
 
 #include "memory.hpp" 
 #include <functional>
+#include <memory>
+#include <string>
 
 class Allocator {
 public:
     virtual Block* allocate(Memory& mem, size_t size, int id) = 0;
+    // Placement for the copy fallback follows the strategy (first fit here)
+    virtual Block* reallocate(Memory& mem, int id, size_t size) { return mem.reallocate(id, size); }
+    // Start offset a multiple of `align` (a power of two), placed like allocate()
+    virtual Block* allocateAligned(Memory& mem, size_t size, size_t align, int id) {
+        return mem.allocateAligned(size, align, id);
+    }
+    virtual const char* name() const = 0;
+    // Strategies with private state (buddy free lists) persist it here
+    virtual void save(SnapshotWriter&) const {}
+    virtual bool load(SnapshotReader&) { return true; }
+    // Whether the blocks handed out live in Memory's block list. Regions,
+    // tiering and compare find, free and measure blocks through that list.
+    virtual bool ownsMemoryBlocks() const { return true; }
     virtual ~Allocator() {}
 };
 
 class FirstFit : public Allocator {
 public:
     Block* allocate(Memory& mem, size_t size, int id) override;
+    const char* name() const override { return "first_fit"; }
 };
 
 class BestFit : public Allocator {
 public:
     Block* allocate(Memory& mem, size_t size, int id) override;
+    Block* reallocate(Memory& mem, int id, size_t size) override;
+    Block* allocateAligned(Memory& mem, size_t size, size_t align, int id) override;
+    const char* name() const override { return "best_fit"; }
 };
 
 class WorstFit : public Allocator {
 public:
     Block* allocate(Memory& mem, size_t size, int id) override;
+    Block* reallocate(Memory& mem, int id, size_t size) override;
+    Block* allocateAligned(Memory& mem, size_t size, size_t align, int id) override;
+    const char* name() const override { return "worst_fit"; }
 };
 
 class BuddyAllocator : public Allocator {
 public:
     BuddyAllocator(size_t mem_size);
     Block* allocate(Memory& mem, size_t size, int id) override;
+    // A 2^k buddy block is 2^k-aligned, so the request is rounded up to `align`
+    Block* allocateAligned(Memory& mem, size_t size, size_t align, int id) override;
     void deallocate(Memory& mem, int id);
+    const char* name() const override { return "buddy"; }
+    bool ownsMemoryBlocks() const override { return false; }   // Free lists are private
+    void save(SnapshotWriter& w) const override;
+    bool load(SnapshotReader& r) override;
 private:
     size_t mem_size;
     std::vector<std::list<Block*>> free_lists;
     size_t get_power_of_two(size_t size);
 };
 
-#endif
\ No newline at end of file
+// Factory: returns nullptr for an unknown strategy name
+std::unique_ptr<Allocator> createAllocator(const std::string& type, size_t mem_size);
+
+#endif
@@ -1,7 +1,17 @@
 #include "allocator.hpp"
 
+static Block* smallerBlock(Block* a, Block* b) {
+    return (a->size < b->size) ? a : b;
+}
+
 Block* BestFit::allocate(Memory& mem, size_t size, int id) {
-    return mem.allocateWithSelect(size, id, [](Block* a, Block* b) {
-        return (a->size < b->size) ? a : b;
-    });
+    return mem.allocateWithSelect(size, id, smallerBlock);
+}
+
+Block* BestFit::reallocate(Memory& mem, int id, size_t size) {
+    return mem.reallocate(id, size, smallerBlock);
+}
+
+Block* BestFit::allocateAligned(Memory& mem, size_t size, size_t align, int id) {
+    return mem.allocateAligned(size, align, id, smallerBlock);
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "allocator.hpp"
+#include "snapshot.hpp"
+#include <algorithm>
 #include <cmath>
 
 BuddyAllocator::BuddyAllocator(size_t mem_size) : mem_size(mem_size) {
@@ -16,7 +18,7 @@ size_t BuddyAllocator::get_power_of_two(size_t size) {
 Block* BuddyAllocator::allocate(Memory& mem, size_t size, int id) {
     size_t alloc_size = get_power_of_two(size);
     int order = std::log2(alloc_size);
-    for (size_t i = order; i <= free_lists.size(); ++i) {
+    for (size_t i = order; i < free_lists.size(); ++i) {
         if (!free_lists[i].empty()) {
             Block* block = free_lists[i].front();
             free_lists[i].pop_front();
@@ -35,5 +37,46 @@ Block* BuddyAllocator::allocate(Memory& mem, size_t size, int id) {
     return nullptr;
 }
 
+Block* BuddyAllocator::allocateAligned(Memory& mem, size_t size, size_t align, int id) {
+    if (align == 0 || (align & (align - 1)) != 0)
+        return nullptr;
+    return allocate(mem, std::max(size, align), id);
+}
+
 void BuddyAllocator::deallocate(Memory& mem, int id) {
+}
+
+void BuddyAllocator::save(SnapshotWriter& w) const {
+    w.put<uint64_t>(mem_size);
+    w.put<uint32_t>(static_cast<uint32_t>(free_lists.size()));
+    for (const auto& list : free_lists) {
+        w.put<uint64_t>(list.size());
+        for (const Block* b : list)
+            w.put<uint64_t>(b->size);
+    }
+}
+
+bool BuddyAllocator::load(SnapshotReader& r) {
+    uint64_t size;
+    uint32_t orders;
+    if (!r.get(size) || !r.get(orders) || size != mem_size || orders != free_lists.size())
+        return false;
+
+    for (auto& list : free_lists)
+        for (Block* b : list)
+            delete b;
+    free_lists.assign(orders, {});
+
+    for (uint32_t order = 0; order < orders; ++order) {
+        uint64_t count;
+        if (!r.get(count) || count > r.remaining() / sizeof(uint64_t))
+            return false;
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t block_size;
+            if (!r.get(block_size) || block_size == 0 || block_size > mem_size)
+                return false;
+            free_lists[order].push_back(new Block{block_size, 0, true, -1, nullptr});
+        }
+    }
+    return true;
 }
\ No newline at end of file
@@ -1,83 +1,231 @@
 #include "cache.hpp"
+#include "instrument.hpp"
+#include "snapshot.hpp"
 #include <iostream>
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 
+namespace {
+const uint8_t RRPV_MAX = 3;             // 2-bit re-reference prediction values
+const uint32_t BRRIP_PERIOD = 32;
+const int PSEL_MAX = 1023;              // 10-bit saturating selector
+const size_t DUEL_STRIDE = 32;          // One SRRIP and one BRRIP leader per 32 sets
+
+struct PolicyEntry {
+    const char* name;
+    ReplacementPolicy policy;
+};
+const PolicyEntry POLICIES[] = {
+    {"LRU", ReplacementPolicy::LRU},
+    {"LFU", ReplacementPolicy::LFU},
+    {"FIFO", ReplacementPolicy::FIFO},
+    {"PLRU", ReplacementPolicy::TreePLRU},
+    {"BIT_PLRU", ReplacementPolicy::BitPLRU},
+    {"SRRIP", ReplacementPolicy::SRRIP},
+    {"BRRIP", ReplacementPolicy::BRRIP},
+    {"DRRIP", ReplacementPolicy::DRRIP},
+    {"ARC", ReplacementPolicy::ARC},
+    {"RANDOM", ReplacementPolicy::Random},
+};
+}
+
+bool parsePolicy(const std::string& name, ReplacementPolicy& policy) {
+    std::string upper = name;
+    for (char& c : upper)
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    for (const PolicyEntry& e : POLICIES)
+        if (upper == e.name) {
+            policy = e.policy;
+            return true;
+        }
+    return false;
+}
+
+const char* policyName(ReplacementPolicy policy) {
+    for (const PolicyEntry& e : POLICIES)
+        if (e.policy == policy)
+            return e.name;
+    return "LRU";
+}
+
 Cache::Cache(size_t size, size_t block_size, int associativity, std::string policy)
     : size(size),
       block_size(block_size),
       associativity(associativity),
       policy(policy),
+      kind(ReplacementPolicy::LRU),
       hits(0),
       misses(0),
       current_time(0)
 {
+    parsePolicy(policy, kind);
+
     // Calculate number of sets
     num_sets = size / (block_size * associativity);
-    sets_data.resize(num_sets, std::vector<CacheLine>(associativity));
+    sets_data.resize(num_sets * associativity);
+    set_counters.resize(num_sets);
+    block_div = FastDivisor(block_size);
+    set_div = FastDivisor(num_sets);
     
-    // Initialize LRU/FIFO structures if needed
-    if (policy == "LRU") {
-        lru_order.resize(num_sets);
-        for (size_t i = 0; i < num_sets; i++) {  // Changed int to size_t
-            for (int j = 0; j < associativity; j++) {
-                lru_order[i].push_back(j);
-            }
-        }
-    } else if (policy == "FIFO") {
-        fifo_order.resize(num_sets);
-        for (size_t i = 0; i < num_sets; i++) {  // Changed int to size_t
-            for (int j = 0; j < associativity; j++) {
-                fifo_order[i].push(j);
-            }
-        }
+    // PLRU state is a single 64-bit word per set
+    bool power_of_two = (associativity & (associativity - 1)) == 0;
+    if ((kind == ReplacementPolicy::TreePLRU && (!power_of_two || associativity > 64)) ||
+        (kind == ReplacementPolicy::BitPLRU && associativity > 64)) {
+        std::cout << "Warning: " << policyName(kind) << " needs associativity <= 64"
+                  << (kind == ReplacementPolicy::TreePLRU ? " (power of two)" : "")
+                  << ", using LRU" << std::endl;
+        kind = ReplacementPolicy::LRU;
     }
+    this->policy = policyName(kind);
+
+    if (kind == ReplacementPolicy::TreePLRU || kind == ReplacementPolicy::BitPLRU)
+        plru_bits.assign(num_sets, 0);
+    else if (kind == ReplacementPolicy::ARC)
+        arc.resize(num_sets);
+    psel = (PSEL_MAX + 1) / 2;
     
     std::cout << "Cache initialized: " 
               << num_sets << " sets, " 
               << associativity << "-way, "
               << "block size: " << block_size 
-              << " bytes, Policy: " << policy << std::endl;
+              << " bytes, Policy: " << this->policy << std::endl;
+}
+
+FastDivisor::FastDivisor(uint64_t d) : divisor(d ? d : 1) {
+    int log2 = 63 - __builtin_clzll(divisor);
+    shift = static_cast<uint8_t>(log2);
+    mask = divisor - 1;
+    pow2 = (divisor & mask) == 0;
+    if (pow2)
+        return;
+
+    // magic = floor(2^(64+log2) / d) * 2 + rounding, plus one
+    unsigned __int128 numerator = static_cast<unsigned __int128>(1) << (64 + log2);
+    uint64_t m = static_cast<uint64_t>(numerator / divisor);
+    uint64_t rem = static_cast<uint64_t>(numerator % divisor);
+    m += m;
+    uint64_t twice_rem = rem + rem;
+    if (twice_rem >= divisor || twice_rem < rem)
+        m++;
+    magic = m + 1;
 }
 
 // Calculate set index from address
 size_t Cache::getSetIndex(uint64_t address) const {
-    uint64_t block_address = address / block_size;
-    return block_address % num_sets;
+    uint64_t block_address = block_div.div(address);
+    return set_div.mod(block_address);
 }
 
 // Calculate tag from address
 uint64_t Cache::getTag(uint64_t address) const {
-    uint64_t block_address = address / block_size;
-    return block_address / num_sets;  // Remove set index bits
+    uint64_t block_address = block_div.div(address);
+    return set_div.div(block_address);  // Remove set index bits
 }
 
 // Calculate block offset
 size_t Cache::getBlockOffset(uint64_t address) const {
-    return address % block_size;
+    return block_div.mod(address);
 }
 
 bool Cache::access(uint64_t address, bool& hit) {
+    INSTR_TIME(Probe::CacheAccess);
+    hit = lookup(address, true);
+    return hit;
+}
+
+// Functional warming: same state transitions as access(), no statistics
+bool Cache::warm(uint64_t address) {
+    return lookup(address, false);
+}
+
+size_t Cache::accessBatch(const uint64_t* addresses, size_t n, uint8_t* hit_out) {
+    const size_t TILE = 16;
+    size_t set_index[TILE];
+    uint64_t tag[TILE];
+    size_t batch_hits = 0;
+
+    for (size_t base = 0; base < n; base += TILE) {
+        size_t len = std::min(TILE, n - base);
+        for (size_t i = 0; i < len; i++) {
+            uint64_t block_address = block_div.div(addresses[base + i]);
+            tag[i] = set_div.div(block_address);
+            set_index[i] = block_address - tag[i] * num_sets;
+            __builtin_prefetch(setLines(set_index[i]));
+        }
+        for (size_t i = 0; i < len; i++) {
+            bool hit = lookupAt(set_index[i], tag[i], true);
+            batch_hits += hit;
+            if (hit_out)
+                hit_out[base + i] = hit;
+        }
+    }
+    return batch_hits;
+}
+
+void Cache::warmBatch(Cache& l1, Cache* l2, const uint64_t* addresses, size_t n) {
+    const size_t TILE = 16;
+    size_t set1[TILE], set2[TILE];
+    uint64_t tag1[TILE], tag2[TILE];
+
+    for (size_t base = 0; base < n; base += TILE) {
+        size_t len = std::min(TILE, n - base);
+        for (size_t i = 0; i < len; i++) {
+            uint64_t block_address = l1.block_div.div(addresses[base + i]);
+            tag1[i] = l1.set_div.div(block_address);
+            set1[i] = block_address - tag1[i] * l1.num_sets;
+            __builtin_prefetch(l1.setLines(set1[i]));
+            if (l2) {
+                block_address = l2->block_div.div(addresses[base + i]);
+                tag2[i] = l2->set_div.div(block_address);
+                set2[i] = block_address - tag2[i] * l2->num_sets;
+                __builtin_prefetch(l2->setLines(set2[i]));
+            }
+        }
+        for (size_t i = 0; i < len; i++) {
+            if (l1.lookupAt(set1[i], tag1[i], false) || !l2)
+                continue;
+            if (l2->lookupAt(set2[i], tag2[i], false))
+                l1.lookupAt(set1[i], tag1[i], false);
+        }
+    }
+}
+
+bool Cache::lookup(uint64_t address, bool count) {
+    return lookupAt(getSetIndex(address), getTag(address), count);
+}
+
+bool Cache::lookupAt(size_t set_index, uint64_t tag, bool count) {
     current_time++;
     
-    size_t set_index = getSetIndex(address);
-    uint64_t tag = getTag(address);
-    
-    auto& set = sets_data[set_index];
+    CacheLine* set = setLines(set_index);
     
     // --------- HIT CHECK ----------
     for (int way = 0; way < associativity; way++) {
         if (set[way].valid && set[way].tag == tag) {
-            hit = true;
-            hits++;
+            if (count) {
+                hits++;
+                set_counters[set_index].hits++;
+            }
             updateAccess(set_index, way, true);
             return true;
         }
     }
     
     // --------- MISS ----------
-    hit = false;
-    misses++;
+    if (count) {
+        misses++;
+        set_counters[set_index].misses++;
+    }
+
+    // DRRIP: misses in leader sets steer the followers
+    if (kind == ReplacementPolicy::DRRIP) {
+        if (set_index % DUEL_STRIDE == 0)
+            psel = std::min(psel + 1, PSEL_MAX);
+        else if (set_index % DUEL_STRIDE == 1)
+            psel = std::max(psel - 1, 0);
+    }
+    int arc_ghost = kind == ReplacementPolicy::ARC ? arcGhostHit(static_cast<int>(set_index), tag) : 0;
     
     // Find an invalid line first
     int victim_way = -1;
@@ -89,38 +237,93 @@ bool Cache::access(uint64_t address, bool& hit) {
     }
     
     // If all lines are valid, use replacement policy
-    if (victim_way == -1) {
-        if (policy == "LRU") {
-            victim_way = findLRUVictim(static_cast<int>(set_index));  // Cast to int
-        } else if (policy == "LFU") {
-            victim_way = findLFUVictim(static_cast<int>(set_index));  // Cast to int
-        } else if (policy == "FIFO") {
-            victim_way = findFIFOVictim(static_cast<int>(set_index)); // Cast to int
-        } else {
-            // Default to LRU
-            victim_way = findLRUVictim(static_cast<int>(set_index));  // Cast to int
+    if (victim_way == -1)
+        victim_way = findVictim(static_cast<int>(set_index), arc_ghost);
+    
+    last_eviction.valid = set[victim_way].valid;
+    if (last_eviction.valid) {
+        if (count) {
+            evictions++;
+            set_counters[set_index].evictions++;
         }
+        last_eviction.address = (set[victim_way].tag * num_sets + set_index) * block_size;
+        last_eviction.state = set[victim_way].state;
+        if (kind == ReplacementPolicy::ARC)
+            arcRemember(static_cast<int>(set_index), set[victim_way]);
     }
-    
+
     // Replace the victim line
+    set[victim_way].state = 0;
     set[victim_way].valid = true;
     set[victim_way].tag = tag;
     set[victim_way].timestamp = current_time;
+    set[victim_way].freq = 0;
     
-    updateAccess(static_cast<int>(set_index), victim_way, false);  // Cast to int
+    updateAccess(static_cast<int>(set_index), victim_way, false, arc_ghost);
     
     return false;
 }
 
-int Cache::findLRUVictim(int set_index) {
-    // The first element in the list is LRU
-    int lru_way = lru_order[set_index].front();
-    lru_order[set_index].pop_front();
-    return lru_way;
+CacheLine* Cache::probe(uint64_t address) {
+    CacheLine* set = setLines(getSetIndex(address));
+    uint64_t tag = getTag(address);
+    for (int way = 0; way < associativity; way++) {
+        if (set[way].valid && set[way].tag == tag)
+            return &set[way];
+    }
+    return nullptr;
+}
+
+bool Cache::invalidate(uint64_t address) {
+    CacheLine* line = probe(address);
+    if (!line)
+        return false;
+    // The way stays in the replacement order; invalid ways are refilled first
+    line->valid = false;
+    line->dirty = false;
+    line->state = 0;
+    return true;
+}
+
+int Cache::findVictim(int set_index, int arc_ghost) {
+    switch (kind) {
+        case ReplacementPolicy::LFU:
+            return findLFUVictim(set_index);
+        case ReplacementPolicy::TreePLRU:
+        case ReplacementPolicy::BitPLRU:
+            return findPLRUVictim(set_index);
+        case ReplacementPolicy::SRRIP:
+        case ReplacementPolicy::BRRIP:
+        case ReplacementPolicy::DRRIP:
+            return findRRIPVictim(set_index);
+        case ReplacementPolicy::ARC:
+            return findARCVictim(set_index, arc_ghost);
+        case ReplacementPolicy::Random:
+            // xorshift64: deterministic across runs and snapshots
+            rng_state ^= rng_state << 13;
+            rng_state ^= rng_state >> 7;
+            rng_state ^= rng_state << 17;
+            return static_cast<int>(rng_state % associativity);
+        default:
+            // LRU stamps every use, FIFO only the fill
+            return findOldest(set_index, 0);
+    }
+}
+
+int Cache::findOldest(int set_index, uint8_t arc_list) const {
+    const CacheLine* set = setLines(set_index);
+    int victim_way = -1;
+    for (int way = 0; way < associativity; way++) {
+        if (arc_list && set[way].repl != arc_list)
+            continue;
+        if (victim_way == -1 || set[way].timestamp < set[victim_way].timestamp)
+            victim_way = way;
+    }
+    return victim_way;
 }
 
 int Cache::findLFUVictim(int set_index) {
-    auto& set = sets_data[set_index];
+    const CacheLine* set = setLines(set_index);
     int victim_way = 0;
     int min_freq = set[0].freq;
     
@@ -134,47 +337,268 @@ int Cache::findLFUVictim(int set_index) {
     return victim_way;
 }
 
-int Cache::findFIFOVictim(int set_index) {
-    int fifo_way = fifo_order[set_index].front();
-    fifo_order[set_index].pop();
-    return fifo_way;
+int Cache::findPLRUVictim(int set_index) const {
+    uint64_t bits = plru_bits[set_index];
+    if (kind == ReplacementPolicy::BitPLRU) {
+        // First way whose MRU bit is clear
+        for (int way = 0; way < associativity; way++)
+            if (!(bits >> way & 1))
+                return way;
+        return 0;
+    }
+
+    // Follow the tree bits from the root (node 1); 0 = left, 1 = right
+    int node = 1;
+    int way = 0;
+    for (int width = associativity; width > 1; width >>= 1) {
+        int dir = static_cast<int>(bits >> node & 1);
+        way = way << 1 | dir;
+        node = node << 1 | dir;
+    }
+    return way;
+}
+
+int Cache::findRRIPVictim(int set_index) {
+    CacheLine* set = setLines(set_index);
+    // Ageing every line until one reaches RRPV_MAX is one pass: find the
+    // oldest prediction and add the missing distance to all of them
+    int victim_way = 0;
+    for (int way = 1; way < associativity; way++)
+        if (set[way].repl > set[victim_way].repl)
+            victim_way = way;
+    uint8_t age = RRPV_MAX - set[victim_way].repl;
+    if (age)
+        for (int way = 0; way < associativity; way++)
+            set[way].repl += age;
+    return victim_way;
+}
+
+// Replace from T1 while it is larger than its target p, otherwise from T2
+int Cache::findARCVictim(int set_index, int arc_ghost) const {
+    const CacheLine* set = setLines(set_index);
+    int t1 = 0;
+    for (int way = 0; way < associativity; way++)
+        t1 += set[way].repl == 1;
+    int p = arc[set_index].p;
+    bool from_t1 = t1 > 0 && (t1 > p || (arc_ghost == 2 && t1 == p) || t1 == associativity);
+    return findOldest(set_index, from_t1 ? 1 : 2);
+}
+
+// Returns 1 or 2 if the tag was in ghost list B1/B2 and adapts p
+int Cache::arcGhostHit(int set_index, uint64_t tag) {
+    ArcSet& a = arc[set_index];
+    auto it = std::find(a.b1.begin(), a.b1.end(), tag);
+    if (it != a.b1.end()) {
+        int delta = std::max<int>(1, static_cast<int>(a.b2.size() / a.b1.size()));
+        a.p = std::min(associativity, a.p + delta);
+        a.b1.erase(it);
+        return 1;
+    }
+    it = std::find(a.b2.begin(), a.b2.end(), tag);
+    if (it != a.b2.end()) {
+        int delta = std::max<int>(1, static_cast<int>(a.b1.size() / a.b2.size()));
+        a.p = std::max(0, a.p - delta);
+        a.b2.erase(it);
+        return 2;
+    }
+    return 0;
+}
+
+void Cache::arcRemember(int set_index, const CacheLine& line) {
+    std::vector<uint64_t>& ghosts = line.repl == 1 ? arc[set_index].b1 : arc[set_index].b2;
+    if (static_cast<int>(ghosts.size()) >= associativity)
+        ghosts.erase(ghosts.begin());
+    ghosts.push_back(line.tag);
+}
+
+ReplacementPolicy Cache::rripMode(int set_index) const {
+    if (kind != ReplacementPolicy::DRRIP)
+        return kind;
+    if (set_index % DUEL_STRIDE == 0)
+        return ReplacementPolicy::SRRIP;
+    if (set_index % DUEL_STRIDE == 1)
+        return ReplacementPolicy::BRRIP;
+    // Followers take whichever leader group is missing less
+    return psel <= PSEL_MAX / 2 ? ReplacementPolicy::SRRIP : ReplacementPolicy::BRRIP;
 }
 
-void Cache::updateAccess(int set_index, int way, bool is_hit) {
-    if (policy == "LRU") {
-        // Move this way to the back (most recently used)
-        auto& lru_list = lru_order[set_index];
-        
-        // Remove from current position
-        for (auto it = lru_list.begin(); it != lru_list.end(); ++it) {
-            if (*it == way) {
-                lru_list.erase(it);
-                break;
+void Cache::updateAccess(int set_index, int way, bool is_hit, int arc_ghost) {
+    CacheLine& line = setLines(set_index)[way];
+    switch (kind) {
+        case ReplacementPolicy::LRU:
+            line.timestamp = current_time;
+            break;
+        case ReplacementPolicy::LFU:
+            if (is_hit)
+                line.freq++;
+            break;
+        case ReplacementPolicy::TreePLRU: {
+            // Point every node on the path away from this way
+            uint64_t& bits = plru_bits[set_index];
+            int node = 1;
+            for (int width = associativity >> 1; width >= 1; width >>= 1) {
+                int dir = (way & width) ? 1 : 0;
+                if (dir)
+                    bits &= ~(1ULL << node);
+                else
+                    bits |= 1ULL << node;
+                node = node << 1 | dir;
             }
+            break;
         }
-        
-        // Add to back (MRU position)
-        lru_list.push_back(way);
-    } 
-    else if (policy == "LFU" && is_hit) {
-        sets_data[set_index][way].freq++;
-    }
-    else if (policy == "FIFO" && !is_hit) {
-        // For FIFO, only update on miss (when line is added)
-        fifo_order[set_index].push(way);
+        case ReplacementPolicy::BitPLRU: {
+            uint64_t& bits = plru_bits[set_index];
+            uint64_t all = associativity == 64 ? ~0ULL : (1ULL << associativity) - 1;
+            bits |= 1ULL << way;
+            if (bits == all)
+                bits = 1ULL << way;
+            break;
+        }
+        case ReplacementPolicy::SRRIP:
+        case ReplacementPolicy::BRRIP:
+        case ReplacementPolicy::DRRIP:
+            if (is_hit)
+                line.repl = 0;
+            else if (rripMode(set_index) == ReplacementPolicy::SRRIP)
+                line.repl = RRPV_MAX - 1;
+            else
+                line.repl = ++brrip_tick % BRRIP_PERIOD == 0 ? RRPV_MAX - 1 : RRPV_MAX;
+            break;
+        case ReplacementPolicy::ARC:
+            // Re-use (or a ghost hit) promotes to the frequency list T2
+            line.repl = (is_hit || arc_ghost) ? 2 : 1;
+            line.timestamp = current_time;
+            break;
+        default:
+            break;
     }
 }
 
 void Cache::report() const {
-    int total_accesses = hits + misses;
+    uint64_t total_accesses = hits + misses;
     double hit_rate = getHitRate();
     
     std::cout << "\n===== Cache Statistics =====\n";
     std::cout << "Hits: " << hits << "\n";
     std::cout << "Misses: " << misses << "\n";
     std::cout << "Total accesses: " << total_accesses << "\n";
+    std::cout << "Evictions: " << evictions << "\n";
     std::cout << "Hit rate: " << hit_rate << "%\n";
     std::cout << "Miss rate: " << (100.0 - hit_rate) << "%\n";
     std::cout << "Policy: " << policy << "\n";
     std::cout << "=============================\n";
+}
+
+namespace {
+struct SnapshotLine {
+    uint64_t tag;
+    int64_t timestamp;
+    int32_t freq;
+    uint8_t valid;
+    uint8_t dirty;
+    uint8_t state;
+    uint8_t repl;
+};
+}
+
+void Cache::save(SnapshotWriter& w) const {
+    w.put<uint64_t>(size);
+    w.put<uint64_t>(block_size);
+    w.put<int32_t>(associativity);
+    w.putString(policy);
+    w.put<uint64_t>(hits);
+    w.put<uint64_t>(misses);
+    w.put<uint64_t>(evictions);
+    w.put<int64_t>(current_time);
+
+    for (const CacheLine& line : sets_data) {
+        SnapshotLine rec{line.tag, line.timestamp, line.freq, line.valid, line.dirty, line.state, line.repl};
+        w.put(rec);
+    }
+    w.putBytes(set_counters.data(), set_counters.size() * sizeof(SetCounters));
+
+    // Per-set replacement state; LRU/FIFO/LFU/RRIP live in the lines above
+    w.put<int32_t>(psel);
+    w.put<uint32_t>(brrip_tick);
+    w.put<uint64_t>(rng_state);
+    for (uint64_t bits : plru_bits)
+        w.put<uint64_t>(bits);
+    for (const ArcSet& a : arc) {
+        w.put<int32_t>(a.p);
+        for (const auto* ghosts : {&a.b1, &a.b2}) {
+            w.put<uint32_t>(static_cast<uint32_t>(ghosts->size()));
+            for (uint64_t tag : *ghosts)
+                w.put<uint64_t>(tag);
+        }
+    }
+}
+
+std::unique_ptr<Cache> Cache::restore(SnapshotReader& r) {
+    uint64_t size, block_size;
+    int32_t associativity;
+    std::string policy;
+    uint64_t hits, misses, evictions;
+    int64_t current_time;
+    if (!r.get(size) || !r.get(block_size) || !r.get(associativity) ||
+        !r.getString(policy) || !r.get(hits) || !r.get(misses) || !r.get(evictions) || !r.get(current_time))
+        return nullptr;
+
+    // Reject geometries the constructor cannot build, and line arrays the
+    // file cannot hold, before allocating them
+    ReplacementPolicy kind;
+    if (!validGeometry(size, block_size, associativity) || !parsePolicy(policy, kind) ||
+        size / block_size > r.remaining() / sizeof(SnapshotLine))
+        return nullptr;
+
+    std::unique_ptr<Cache> cache = std::make_unique<Cache>(size, block_size, associativity, policy);
+    cache->hits = hits;
+    cache->misses = misses;
+    cache->evictions = evictions;
+    cache->current_time = current_time;
+
+    size_t lines = cache->num_sets * associativity;
+    const uint8_t* records = r.take(lines * sizeof(SnapshotLine));
+    if (!records)
+        return nullptr;
+    for (size_t i = 0; i < lines; i++) {
+        SnapshotLine rec;
+        std::memcpy(&rec, records + i * sizeof(SnapshotLine), sizeof(rec));
+        CacheLine& line = cache->sets_data[i];
+        line.tag = rec.tag;
+        line.timestamp = rec.timestamp;
+        line.freq = rec.freq;
+        line.valid = rec.valid != 0;
+        line.dirty = rec.dirty != 0;
+        line.state = rec.state;
+        line.repl = rec.repl;
+    }
+    size_t counter_bytes = cache->num_sets * sizeof(SetCounters);
+    const uint8_t* counters = r.take(counter_bytes);
+    if (!counters)
+        return nullptr;
+    std::memcpy(cache->set_counters.data(), counters, counter_bytes);
+
+    int32_t psel;
+    if (!r.get(psel) || !r.get(cache->brrip_tick) || !r.get(cache->rng_state))
+        return nullptr;
+    cache->psel = psel;
+    for (uint64_t& bits : cache->plru_bits)
+        if (!r.get(bits))
+            return nullptr;
+    for (ArcSet& a : cache->arc) {
+        int32_t p;
+        if (!r.get(p))
+            return nullptr;
+        a.p = p;
+        for (auto* ghosts : {&a.b1, &a.b2}) {
+            uint32_t n;
+            if (!r.get(n) || n > static_cast<uint32_t>(associativity))
+                return nullptr;
+            ghosts->resize(n);
+            for (uint64_t& tag : *ghosts)
+                if (!r.get(tag))
+                    return nullptr;
+        }
+    }
+    return cache;
 }
\ No newline at end of file
@@ -2,58 +2,168 @@
 #define CACHE_HPP
 #include <string>
 #include <vector>
-#include <list>
-#include <queue>
-#include <unordered_map>
 #include <cstdint>
+#include <memory>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+enum class ReplacementPolicy {
+    LRU, LFU, FIFO,
+    TreePLRU,   // Binary tree of assoc-1 bits (power-of-two assoc <= 64)
+    BitPLRU,    // One MRU bit per way (assoc <= 64)
+    SRRIP, BRRIP, DRRIP,
+    ARC,
+    Random
+};
+
+// Policy names as typed at `init cache` (case-insensitive); false if unknown
+bool parsePolicy(const std::string& name, ReplacementPolicy& policy);
+const char* policyName(ReplacementPolicy policy);
 
 struct CacheLine {
     uint64_t tag;
     bool valid;
     bool dirty;
-    int64_t timestamp;  // For LRU/FIFO
+    int64_t timestamp;  // Last use (LRU, ARC) or insertion (FIFO)
     int freq;           // For LFU
+    uint8_t state;      // Coherence state (multi-core simulation only)
+    uint8_t repl;       // RRPV for RRIP; list for ARC (1 = T1, 2 = T2)
     
     // FIX: Initialize members in correct order (same as declaration)
-    CacheLine() : tag(0), valid(false), dirty(false), timestamp(0), freq(0) {}
+    CacheLine() : tag(0), valid(false), dirty(false), timestamp(0), freq(0), state(0), repl(0) {}
+};
+
+// Division by a value fixed at construction: shift/mask for powers of two,
+// otherwise multiply-high by a precomputed reciprocal (exact for all 64-bit
+// dividends, round-up method with the "add" fixup)
+struct FastDivisor {
+    uint64_t divisor = 1, magic = 0, mask = 0;
+    uint8_t shift = 0;
+    bool pow2 = true;
+
+    FastDivisor() {}
+    explicit FastDivisor(uint64_t d);
+
+    uint64_t div(uint64_t x) const {
+        if (pow2)
+            return x >> shift;
+        uint64_t q = static_cast<uint64_t>((static_cast<unsigned __int128>(x) * magic) >> 64);
+        return (((x - q) >> 1) + q) >> shift;
+    }
+    uint64_t mod(uint64_t x) const { return pow2 ? x & mask : x - div(x) * divisor; }
+};
+
+// Per-set activity, for spotting conflict hot spots
+struct SetCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;     // Misses that displaced a valid line
+};
+
+// Line displaced by the most recent miss
+struct CacheEviction {
+    bool valid = false;
+    uint64_t address = 0;
+    uint8_t state = 0;
 };
 
 class Cache {
 public:
     Cache(size_t size, size_t block_size, int associativity, std::string policy);
+
+    // At least one set of positive block size and associativity; callers
+    // check this before constructing
+    static bool validGeometry(size_t size, size_t block_size, int associativity) {
+        return block_size > 0 && associativity > 0
+            && size / block_size >= static_cast<size_t>(associativity);
+    }
+
     bool access(uint64_t address, bool& hit);
+    bool warm(uint64_t address);    // Updates state only; returns hit
+
+    // Same state transitions and counters as calling access() on each address
+    // in order. Works in tiles: index/tag for a tile is computed up front and
+    // the target sets are prefetched before any lookup. hit_out (optional)
+    // receives 1/0 per address; returns the number of hits. Batched accesses
+    // are not individually latency-timed.
+    size_t accessBatch(const uint64_t* addresses, size_t n, uint8_t* hit_out);
+
+    // Functional warming of an L1 (+ optional L2) hierarchy: the same state
+    // transitions as warm() along simulateCacheAccess's path (L1, then L2
+    // with refill into L1 on an L2 hit), in stream order. Both levels' sets
+    // for a tile are prefetched up front, as in accessBatch.
+    static void warmBatch(Cache& l1, Cache* l2, const uint64_t* addresses, size_t n);
+
+    // Coherence hooks: look at / drop a line without touching replacement state
+    CacheLine* probe(uint64_t address);
+    bool invalidate(uint64_t address);
+    const CacheEviction& lastEviction() const { return last_eviction; }
     void report() const;
         size_t getBlockSize() const { return block_size; }
+    ReplacementPolicy getPolicy() const { return kind; }
     // GETTER METHODS - KEEP ONLY ONE COPY!
-    int getHits() const { return hits; }
-    int getMisses() const { return misses; }
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+    uint64_t getEvictions() const { return evictions; }
     double getHitRate() const {
-        int total_accesses = hits + misses;
+        uint64_t total_accesses = hits + misses;
         return (total_accesses > 0) ? (double)hits / total_accesses * 100.0 : 0.0;
     }
+    size_t getNumSets() const { return num_sets; }
+    const std::vector<SetCounters>& getSetCounters() const { return set_counters; }
+
+    // Snapshot support: geometry, counters, every line and replacement order
+    void save(SnapshotWriter& w) const;
+    static std::unique_ptr<Cache> restore(SnapshotReader& r);
     
 private:
     size_t size, block_size, num_sets;
     int associativity;
     std::string policy;
+    ReplacementPolicy kind;
     
-    std::vector<std::vector<CacheLine>> sets_data;
-    std::vector<std::list<int>> lru_order;    // One list per set for LRU order
-    std::vector<std::queue<int>> fifo_order;  // One queue per set for FIFO order
+    FastDivisor block_div, set_div;
+    std::vector<CacheLine> sets_data;   // num_sets * associativity, set-major
+    std::vector<uint64_t> plru_bits;    // One word per set for tree/bit PLRU
+
+    // ARC ghost lists (tags of recently evicted T1/T2 lines, oldest first)
+    struct ArcSet {
+        int p = 0;      // Target size of T1
+        std::vector<uint64_t> b1, b2;
+    };
+    std::vector<ArcSet> arc;
+
+    int psel = 0;               // DRRIP set-dueling counter
+    uint32_t brrip_tick = 0;    // BRRIP inserts near-MRU once every BRRIP_PERIOD fills
+    uint64_t rng_state = 0x2545F4914F6CDD1DULL;
     
-    int hits = 0, misses = 0;
+    uint64_t hits = 0, misses = 0, evictions = 0;
+    std::vector<SetCounters> set_counters;
     int64_t current_time = 0;
+    CacheEviction last_eviction;
     
+    bool lookup(uint64_t address, bool count);
+    bool lookupAt(size_t set_index, uint64_t tag, bool count);
+    CacheLine* setLines(size_t set_index) { return &sets_data[set_index * associativity]; }
+    const CacheLine* setLines(size_t set_index) const { return &sets_data[set_index * associativity]; }
+
     // Helper methods
     size_t getSetIndex(uint64_t address) const;
     uint64_t getTag(uint64_t address) const;
     size_t getBlockOffset(uint64_t address) const;
     
     // Replacement policies
-    int findLRUVictim(int set_index);
+    int findVictim(int set_index, int arc_ghost);
+    int findOldest(int set_index, uint8_t arc_list) const;  // arc_list 0 = any line
     int findLFUVictim(int set_index);
-    int findFIFOVictim(int set_index);
-    void updateAccess(int set_index, int way, bool is_hit);
+    int findPLRUVictim(int set_index) const;
+    int findRRIPVictim(int set_index);
+    int findARCVictim(int set_index, int arc_ghost) const;
+    int arcGhostHit(int set_index, uint64_t tag);
+    void arcRemember(int set_index, const CacheLine& line);
+    ReplacementPolicy rripMode(int set_index) const;
+    void updateAccess(int set_index, int way, bool is_hit, int arc_ghost = 0);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "coherence.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+CoherentSystem::CoherentSystem(int cores, size_t l1_size, size_t l2_size, size_t block_size,
+                               int l1_assoc, int l2_assoc, const std::string& policy,
+                               CoherenceProtocol protocol)
+    : block_size(block_size),
+      protocol(protocol),
+      core_stats(cores),
+      invalidated(cores)
+{
+    for (int c = 0; c < cores; c++)
+        l1.push_back(std::make_unique<Cache>(l1_size, block_size, l1_assoc, policy));
+    l2 = std::make_unique<Cache>(l2_size, block_size, l2_assoc, policy);
+}
+
+// BusRd: other holders downgrade. Returns true if any other core keeps a
+// copy; `supplied` is set when one of them provides the data.
+bool CoherentSystem::snoopRead(int core, uint64_t block, bool& supplied) {
+    bool shared = false;
+    supplied = false;
+    for (int o = 0; o < getCores(); o++) {
+        CacheLine* line = o == core ? nullptr : l1[o]->probe(block);
+        if (!line)
+            continue;
+        shared = true;
+        switch (line->state) {
+            case LINE_MODIFIED:
+                if (protocol == CoherenceProtocol::MOESI) {
+                    line->state = LINE_OWNED;   // Keep the dirty data, share it
+                } else {
+                    bool hit;
+                    writebacks++;
+                    l2->access(block, hit);
+                    line->state = LINE_SHARED;
+                    line->dirty = false;
+                }
+                supplied = true;
+                break;
+            case LINE_OWNED:
+                supplied = true;
+                break;
+            case LINE_EXCLUSIVE:
+                line->state = LINE_SHARED;
+                supplied = true;
+                break;
+            default:
+                break;
+        }
+    }
+    return shared;
+}
+
+// BusRdX / BusUpgr: every other copy is invalidated. Returns true if a
+// cache held the line in M, O or E and supplied the data.
+bool CoherentSystem::snoopInvalidate(int core, uint64_t block) {
+    bool supplied = false;
+    for (int o = 0; o < getCores(); o++) {
+        CacheLine* line = o == core ? nullptr : l1[o]->probe(block);
+        if (!line)
+            continue;
+        if (line->state != LINE_SHARED)
+            supplied = true;
+        l1[o]->invalidate(block);
+        core_stats[o].invalidations_received++;
+        invalidated[o].insert(block);
+    }
+    return supplied;
+}
+
+void CoherentSystem::fill(int core, uint64_t block, uint8_t state, bool from_cache) {
+    bool hit;
+    if (from_cache) {
+        interventions++;
+    } else {
+        l2->access(block, hit);
+        (hit ? l2_hits : l2_misses)++;
+    }
+
+    l1[core]->access(block, hit);
+    const CacheEviction& ev = l1[core]->lastEviction();
+    if (ev.valid && (ev.state == LINE_MODIFIED || ev.state == LINE_OWNED)) {
+        writebacks++;
+        l2->access(ev.address, hit);
+    }
+
+    CacheLine* line = l1[core]->probe(block);
+    line->state = state;
+    line->dirty = state == LINE_MODIFIED;
+}
+
+void CoherentSystem::access(int core, uint64_t address, bool write) {
+    uint64_t block = blockOf(address);
+    CoreStats& cs = core_stats[core];
+    (write ? cs.writes : cs.reads)++;
+
+    CacheLine* line = l1[core]->probe(block);
+    if (line) {
+        bool hit;
+        cs.hits++;
+        l1[core]->access(block, hit);   // Replacement order and per-cache counters
+        if (write) {
+            if (line->state == LINE_SHARED || line->state == LINE_OWNED) {
+                bus_upgrades++;
+                snoopInvalidate(core, block);
+            }
+            line->state = LINE_MODIFIED;    // E -> M is silent
+            line->dirty = true;
+        }
+        return;
+    }
+
+    cs.misses++;
+    if (invalidated[core].erase(block))
+        cs.coherence_misses++;
+
+    if (write) {
+        bus_read_excl++;
+        fill(core, block, LINE_MODIFIED, snoopInvalidate(core, block));
+    } else {
+        bus_reads++;
+        bool supplied;
+        bool shared = snoopRead(core, block, supplied);
+        fill(core, block, shared ? LINE_SHARED : LINE_EXCLUSIVE, supplied);
+    }
+}
+
+void CoherentSystem::run(const std::vector<std::vector<CoreOp>>& streams) {
+    size_t longest = 0;
+    for (const auto& s : streams)
+        longest = std::max(longest, s.size());
+
+    int cores = std::min(getCores(), static_cast<int>(streams.size()));
+    for (size_t i = 0; i < longest; i++)
+        for (int c = 0; c < cores; c++)
+            if (i < streams[c].size())
+                access(c, streams[c][i].address, streams[c][i].write);
+}
+
+void CoherentSystem::report() const {
+    std::cout << "\n===== Coherence Statistics (" << (protocol == CoherenceProtocol::MOESI ? "MOESI" : "MESI") << ") =====\n";
+    std::cout << std::left << std::setw(6) << "core"
+              << std::right << std::setw(12) << "reads"
+              << std::setw(12) << "writes"
+              << std::setw(12) << "hit %"
+              << std::setw(14) << "coh. misses"
+              << std::setw(14) << "invalidated" << "\n";
+
+    std::streamsize precision = std::cout.precision();
+    for (int c = 0; c < getCores(); c++) {
+        const CoreStats& s = core_stats[c];
+        uint64_t total = s.hits + s.misses;
+        std::cout << std::left << std::setw(6) << c
+                  << std::right << std::setw(12) << s.reads
+                  << std::setw(12) << s.writes
+                  << std::setw(12) << std::fixed << std::setprecision(2)
+                  << (total ? 100.0 * s.hits / total : 0.0) << std::defaultfloat
+                  << std::setw(14) << s.coherence_misses
+                  << std::setw(14) << s.invalidations_received << "\n";
+    }
+    std::cout.precision(precision);
+
+    std::cout << "BusRd: " << bus_reads << "\n";
+    std::cout << "BusRdX: " << bus_read_excl << "\n";
+    std::cout << "BusUpgr: " << bus_upgrades << "\n";
+    std::cout << "Cache-to-cache transfers: " << interventions << "\n";
+    std::cout << "Write-backs: " << writebacks << "\n";
+    std::cout << "L2 hits: " << l2_hits << ", L2 misses: " << l2_misses << "\n";
+    std::cout << "==============================\n";
+}
+
+std::vector<std::vector<CoreOp>> generateCoreStreams(int cores, size_t ops_per_core,
+                                                     const std::string& pattern,
+                                                     size_t block_size) {
+    std::vector<std::vector<CoreOp>> streams(cores);
+    if (pattern != "false_sharing" && pattern != "private" &&
+        pattern != "shared_read" && pattern != "migratory")
+        return {};
+
+    auto generate = [&](int core) {
+        std::mt19937_64 gen(0x9E3779B97F4A7C15ULL + core);
+        std::vector<CoreOp>& out = streams[core];
+        out.reserve(ops_per_core);
+        for (size_t i = 0; i < ops_per_core; i++) {
+            uint64_t r = gen();
+            if (pattern == "false_sharing") {
+                // Own 8-byte word inside one of four shared lines
+                uint64_t line = 0x10000 + (i % 4) * block_size;
+                out.push_back({line + (core * 8) % block_size, r % 4 != 0});
+            } else if (pattern == "private") {
+                uint64_t base = 0x100000 + (uint64_t)core * 0x100000;
+                out.push_back({base + (r >> 8) % 0x10000, r % 10 < 3});
+            } else if (pattern == "shared_read") {
+                out.push_back({0x200000 + (r >> 8) % 0x10000, false});
+            } else {
+                // Read-modify-write of a line that all cores migrate through
+                uint64_t line = 0x300000 + ((i / 2 + core) % 16) * block_size;
+                out.push_back({line, i % 2 == 1});
+            }
+        }
+    };
+
+    // Each core's stream is independent, so decode/generate them concurrently
+    std::vector<std::thread> pool;
+    for (int c = 1; c < cores; c++)
+        pool.emplace_back(generate, c);
+    if (cores > 0)
+        generate(0);
+    for (auto& t : pool)
+        t.join();
+    return streams;
+}
+
+bool loadCoreStreams(const std::vector<std::string>& paths,
+                     std::vector<std::vector<CoreOp>>& streams) {
+    streams.assign(paths.size(), {});
+    std::vector<char> ok(paths.size(), 0);
+
+    auto decode = [&](size_t core) {
+        std::ifstream in(paths[core]);
+        if (!in)
+            return;
+        std::string line, op;
+        uint64_t address;
+        while (std::getline(in, line)) {
+            std::istringstream iss(line);
+            if (iss >> op >> std::hex >> address && (op == "r" || op == "w"))
+                streams[core].push_back({address, op == "w"});
+        }
+        ok[core] = 1;
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t c = 1; c < paths.size(); c++)
+        pool.emplace_back(decode, c);
+    if (!paths.empty())
+        decode(0);
+    for (auto& t : pool)
+        t.join();
+
+    for (char k : ok)
+        if (!k)
+            return false;
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef COHERENCE_HPP
+#define COHERENCE_HPP
+
+#include "cache.hpp"
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+enum class CoherenceProtocol { MESI, MOESI };
+
+// Stored in CacheLine::state of the private L1s
+enum LineState : uint8_t {
+    LINE_INVALID = 0,
+    LINE_SHARED,
+    LINE_EXCLUSIVE,
+    LINE_MODIFIED,
+    LINE_OWNED      // MOESI only: dirty, possibly shared, this cache supplies data
+};
+
+struct CoreOp {
+    uint64_t address;
+    bool write;
+};
+
+struct CoreStats {
+    uint64_t reads = 0, writes = 0;
+    uint64_t hits = 0, misses = 0;
+    uint64_t coherence_misses = 0;      // Misses on lines another core invalidated
+    uint64_t invalidations_received = 0;
+};
+
+// N private L1 caches kept coherent by a snooping bus over one shared L2.
+// The L2 is non-inclusive; it sees bus fetches and dirty write-backs.
+class CoherentSystem {
+public:
+    CoherentSystem(int cores, size_t l1_size, size_t l2_size, size_t block_size,
+                   int l1_assoc, int l2_assoc, const std::string& policy,
+                   CoherenceProtocol protocol);
+
+    void access(int core, uint64_t address, bool write);
+    // Interleaves the per-core streams round robin, one op per core per step
+    void run(const std::vector<std::vector<CoreOp>>& streams);
+    void report() const;
+
+    int getCores() const { return static_cast<int>(l1.size()); }
+    size_t getBlockSize() const { return block_size; }
+
+private:
+    size_t block_size;
+    CoherenceProtocol protocol;
+    std::vector<std::unique_ptr<Cache>> l1;
+    std::unique_ptr<Cache> l2;
+
+    std::vector<CoreStats> core_stats;
+    std::vector<std::unordered_set<uint64_t>> invalidated;   // Block addresses
+
+    uint64_t bus_reads = 0;         // BusRd
+    uint64_t bus_read_excl = 0;     // BusRdX
+    uint64_t bus_upgrades = 0;      // BusUpgr
+    uint64_t interventions = 0;     // Cache-to-cache transfers
+    uint64_t writebacks = 0;
+    uint64_t l2_hits = 0, l2_misses = 0;
+
+    uint64_t blockOf(uint64_t address) const { return address - address % block_size; }
+    bool snoopRead(int core, uint64_t block, bool& supplied);
+    bool snoopInvalidate(int core, uint64_t block);
+    void fill(int core, uint64_t block, uint8_t state, bool from_cache);
+};
+
+// Per-core synthetic streams (generated concurrently, one thread per core):
+// false_sharing - every core writes its own word of the same few lines
+// private       - every core reads/writes a disjoint region
+// shared_read   - every core reads the same region
+// migratory     - cores take turns read-modify-writing the same lines
+std::vector<std::vector<CoreOp>> generateCoreStreams(int cores, size_t ops_per_core,
+                                                     const std::string& pattern,
+                                                     size_t block_size);
+
+// One "r|w <hex_address>" trace file per core, decoded in parallel.
+// Returns false if any file cannot be read.
+bool loadCoreStreams(const std::vector<std::string>& paths,
+                     std::vector<std::vector<CoreOp>>& streams);
+
+#endif
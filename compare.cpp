@@ -0,0 +1,203 @@
+#include "compare.hpp"
+#include "memory.hpp"
+#include "allocator.hpp"
+#include "cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace {
+CompareResult replay(const std::vector<TraceEvent>& trace, const std::string& strategy, size_t heap) {
+    CompareResult res;
+    res.strategy = strategy;
+    res.heap_size = heap;
+
+    if (heap == 0)
+        return res;
+    // Memory-based metrics need the blocks to be in Memory's list
+    std::unique_ptr<Allocator> alloc = createAllocator(strategy, heap);
+    if (!alloc || !alloc->ownsMemoryBlocks())
+        return res;
+    Memory mem(heap);
+
+    TraceIdMap ids;
+    int next_id = 1;
+    auto start = std::chrono::steady_clock::now();
+    for (const TraceEvent& ev : trace) {
+        int id;
+        switch (ev.op) {
+            case TraceOp::Malloc:
+            case TraceOp::AlignedMalloc:
+                res.mallocs++;
+                if (ev.op == TraceOp::Malloc ? alloc->allocate(mem, ev.size, next_id)
+                                             : alloc->allocateAligned(mem, ev.size, ev.align, next_id))
+                    ids.allocated(ev, next_id++);
+                else
+                    res.failures++;
+                break;
+            case TraceOp::Realloc:
+                if ((id = ids.find(ev)) >= 0)
+                    alloc->reallocate(mem, id, ev.size);
+                break;
+            case TraceOp::Free:
+                if ((id = ids.find(ev)) >= 0) {
+                    mem.deallocate(id);
+                    ids.erase(ev);
+                }
+                break;
+        }
+    }
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    res.used = mem.getUsedSize();
+    res.external_fragmentation = mem.getExternalFragmentation();
+    res.internal_fragmentation = mem.getInternalFragmentation();
+    res.valid = true;
+    return res;
+}
+
+std::vector<uint64_t> scanHeavy(size_t lines, size_t block_size, size_t accesses) {
+    std::mt19937_64 gen(42);
+    std::vector<uint64_t> out;
+    out.reserve(accesses);
+    size_t hot = std::max<size_t>(1, lines / 2);
+    uint64_t scan_next = lines * 16;    // Scans never revisit a block
+    while (out.size() < accesses) {
+        for (size_t i = 0; i < 2 * lines && out.size() < accesses; i++)
+            out.push_back((gen() % hot) * block_size);
+        for (size_t i = 0; i < 2 * lines && out.size() < accesses; i++)
+            out.push_back(scan_next++ * block_size);
+    }
+    return out;
+}
+
+std::vector<uint64_t> loopHeavy(size_t lines, size_t block_size, size_t accesses) {
+    std::vector<uint64_t> out;
+    out.reserve(accesses);
+    size_t span = std::max<size_t>(2, lines + lines / 2);
+    for (size_t i = 0; i < accesses; i++)
+        out.push_back((i % span) * block_size);
+    return out;
+}
+}
+
+std::vector<CompareResult> runComparison(const std::vector<TraceEvent>& trace,
+                                         const std::vector<std::string>& strategies,
+                                         const std::vector<size_t>& heap_sizes,
+                                         unsigned threads) {
+    size_t jobs = strategies.size() * heap_sizes.size();
+    std::vector<CompareResult> results(jobs);
+    if (jobs == 0)
+        return results;
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads > jobs)
+        threads = static_cast<unsigned>(jobs);
+
+    // Work stealing over a shared job counter; every job writes its own slot
+    std::atomic<size_t> next_job{0};
+    auto worker = [&]() {
+        for (size_t j; (j = next_job.fetch_add(1)) < jobs;)
+            results[j] = replay(trace, strategies[j % strategies.size()],
+                                heap_sizes[j / strategies.size()]);
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool)
+        t.join();
+    return results;
+}
+
+void printComparison(const std::vector<CompareResult>& results, size_t events) {
+    std::cout << "\n===== Allocator Comparison =====\n";
+    std::cout << std::left << std::setw(12) << "strategy"
+              << std::right << std::setw(12) << "heap"
+              << std::setw(14) << "ops/sec"
+              << std::setw(12) << "fail %"
+              << std::setw(12) << "ext frag %"
+              << std::setw(14) << "int frag (B)"
+              << std::setw(10) << "util %" << "\n";
+
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2);
+    for (const CompareResult& r : results) {
+        std::cout << std::left << std::setw(12) << r.strategy
+                  << std::right << std::setw(12) << r.heap_size;
+        if (!r.valid) {
+            std::cout << "  unknown strategy\n";
+            continue;
+        }
+        double ops = r.seconds > 0 ? events / r.seconds : 0.0;
+        double fail = r.mallocs ? 100.0 * r.failures / r.mallocs : 0.0;
+        std::cout << std::setw(14) << std::setprecision(0) << ops
+                  << std::setw(12) << std::setprecision(2) << fail
+                  << std::setw(12) << r.external_fragmentation
+                  << std::setw(14) << std::setprecision(0) << r.internal_fragmentation
+                  << std::setw(10) << std::setprecision(2) << 100.0 * r.used / r.heap_size << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+    std::cout << "================================\n";
+}
+
+std::vector<PolicyResult> runPolicyComparison(size_t cache_size, size_t block_size,
+                                              int associativity,
+                                              const std::vector<std::string>& policies,
+                                              size_t accesses) {
+    std::vector<PolicyResult> results;
+    if (!Cache::validGeometry(cache_size, block_size, associativity))
+        return results;
+
+    size_t lines = cache_size / block_size;
+    const std::pair<const char*, std::vector<uint64_t>> workloads[] = {
+        {"scan", scanHeavy(lines, block_size, accesses)},
+        {"loop", loopHeavy(lines, block_size, accesses)},
+    };
+
+    for (const std::string& policy : policies) {
+        // Built once; each workload starts from a cold copy
+        const Cache cold(cache_size, block_size, associativity, policy);
+        for (const auto& workload : workloads) {
+            Cache cache = cold;
+            bool hit;
+            auto start = std::chrono::steady_clock::now();
+            for (uint64_t addr : workload.second)
+                cache.access(addr, hit);
+
+            PolicyResult r;
+            r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            r.policy = policyName(cache.getPolicy());
+            r.workload = workload.first;
+            r.hit_rate = cache.getHitRate();
+            results.push_back(r);
+        }
+    }
+    return results;
+}
+
+void printPolicyComparison(const std::vector<PolicyResult>& results, size_t accesses) {
+    std::cout << "\n===== Replacement Policy Comparison =====\n";
+    std::cout << std::left << std::setw(10) << "policy"
+              << std::setw(10) << "workload"
+              << std::right << std::setw(10) << "hit %"
+              << std::setw(16) << "accesses/sec" << "\n";
+
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed;
+    for (const PolicyResult& r : results) {
+        std::cout << std::left << std::setw(10) << r.policy
+                  << std::setw(10) << r.workload
+                  << std::right << std::setw(10) << std::setprecision(2) << r.hit_rate
+                  << std::setw(16) << std::setprecision(0)
+                  << (r.seconds > 0 ? accesses / r.seconds : 0.0) << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+    std::cout << "=========================================\n";
+}
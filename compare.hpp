@@ -0,0 +1,47 @@
+#ifndef COMPARE_HPP
+#define COMPARE_HPP
+
+#include "trace.hpp"
+#include <string>
+#include <vector>
+
+struct CompareResult {
+    std::string strategy;
+    size_t heap_size = 0;
+    double seconds = 0.0;
+    size_t mallocs = 0;
+    size_t failures = 0;
+    size_t used = 0;
+    double external_fragmentation = 0.0;
+    double internal_fragmentation = 0.0;
+    bool valid = false;
+};
+
+// Replays one shared, read-only trace against an independent Memory +
+// Allocator per (strategy, heap size) pair. Jobs are spread over `threads`
+// workers (0 = hardware concurrency); each worker owns all of its state.
+std::vector<CompareResult> runComparison(const std::vector<TraceEvent>& trace,
+                                         const std::vector<std::string>& strategies,
+                                         const std::vector<size_t>& heap_sizes,
+                                         unsigned threads = 0);
+
+void printComparison(const std::vector<CompareResult>& results, size_t events);
+
+struct PolicyResult {
+    std::string policy;
+    std::string workload;
+    double hit_rate = 0.0;
+    double seconds = 0.0;
+};
+
+// Runs a fresh cache of the given geometry per replacement policy over two
+// seeded synthetic streams: "scan" (a hot set that fits, broken up by long
+// one-touch scans) and "loop" (a cyclic sweep 1.5x the cache capacity).
+std::vector<PolicyResult> runPolicyComparison(size_t cache_size, size_t block_size,
+                                              int associativity,
+                                              const std::vector<std::string>& policies,
+                                              size_t accesses);
+
+void printPolicyComparison(const std::vector<PolicyResult>& results, size_t accesses);
+
+#endif
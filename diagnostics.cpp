@@ -0,0 +1,116 @@
+#include "diagnostics.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+const char HEATMAP_MAGIC[8] = {'M', 'M', 'H', 'E', 'A', 'T', '0', '1'};
+
+uint8_t percentOf(size_t used, size_t width) {
+    return width ? static_cast<uint8_t>(used * 100 / width) : 0;
+}
+}
+
+HeatmapRecorder::HeatmapRecorder(size_t interval, size_t max_frames)
+    : interval(interval ? interval : 1), max_frames(max_frames) {}
+
+void HeatmapRecorder::tick(const Memory& mem) {
+    if (++ops % interval == 0)
+        capture(mem);
+}
+
+void HeatmapRecorder::capture(const Memory& mem) {
+    if (frames.size() >= max_frames)
+        return;
+
+    const std::vector<size_t>& occ = mem.getOccupancy();
+    bucket_width = mem.getBucketWidth();
+
+    HeatmapFrame frame;
+    frame.op = ops;
+    frame.occupancy.reserve(occ.size());
+    for (size_t used : occ)
+        frame.occupancy.push_back(percentOf(used, bucket_width));
+    frames.push_back(std::move(frame));
+}
+
+bool HeatmapRecorder::writeCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    size_t buckets = frames.empty() ? 0 : frames[0].occupancy.size();
+    out << "op";
+    for (size_t b = 0; b < buckets; b++)
+        out << ",b" << b;
+    out << "\n";
+
+    for (const HeatmapFrame& f : frames) {
+        out << f.op;
+        for (uint8_t v : f.occupancy)
+            out << "," << static_cast<int>(v);
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool HeatmapRecorder::writeBinary(const std::string& path) const {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+
+    uint32_t buckets = frames.empty() ? 0 : static_cast<uint32_t>(frames[0].occupancy.size());
+    uint64_t width = bucket_width;
+    uint64_t count = frames.size();
+    bool ok = std::fwrite(HEATMAP_MAGIC, 1, sizeof(HEATMAP_MAGIC), f) == sizeof(HEATMAP_MAGIC) &&
+              std::fwrite(&buckets, sizeof(buckets), 1, f) == 1 &&
+              std::fwrite(&width, sizeof(width), 1, f) == 1 &&
+              std::fwrite(&count, sizeof(count), 1, f) == 1;
+
+    for (size_t i = 0; ok && i < frames.size(); i++) {
+        ok = std::fwrite(&frames[i].op, sizeof(uint64_t), 1, f) == 1 &&
+             std::fwrite(frames[i].occupancy.data(), 1, buckets, f) == buckets;
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+void printFailure(const AllocFailure& f) {
+    std::cout << "  cause: " << (f.isFragmentation() ? "fragmentation" : "exhaustion")
+              << " (requested " << f.requested
+              << ", free " << f.free_bytes
+              << ", largest free block " << f.largest_free
+              << ", free blocks " << f.free_blocks << ")" << std::endl;
+}
+
+void printHeatmap(const Memory& mem) {
+    static const char SHADES[] = " .:-=+*#%@";
+    const std::vector<size_t>& occ = mem.getOccupancy();
+    size_t width = mem.getBucketWidth();
+
+    std::cout << "Heap occupancy (" << occ.size() << " buckets of "
+              << width << " bytes, ' '=empty '@'=full)\n[";
+    for (size_t used : occ)
+        std::cout << SHADES[percentOf(used, width) * 9 / 100];
+    std::cout << "]" << std::endl;
+}
+
+bool writeFailuresCsv(const Memory& mem, const std::string& path) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    out << "request,requested,free_bytes,largest_free,free_blocks,cause";
+    for (int b = 0; b < AllocFailure::HIST_BUCKETS; b++)
+        out << ",log2_" << b;
+    out << "\n";
+
+    for (const AllocFailure& f : mem.getFailures()) {
+        out << f.request_index << "," << f.requested << "," << f.free_bytes << ","
+            << f.largest_free << "," << f.free_blocks << ","
+            << (f.isFragmentation() ? "fragmentation" : "exhaustion");
+        for (int b = 0; b < AllocFailure::HIST_BUCKETS; b++)
+            out << "," << f.histogram[b];
+        out << "\n";
+    }
+    return static_cast<bool>(out);
+}
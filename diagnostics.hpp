@@ -0,0 +1,39 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include "memory.hpp"
+#include <string>
+#include <vector>
+
+// One heatmap frame: occupancy of every bucket in percent (one byte each)
+struct HeatmapFrame {
+    uint64_t op;
+    std::vector<uint8_t> occupancy;
+};
+
+// Samples Memory's incrementally maintained occupancy every `interval`
+// operations. Each capture costs O(buckets), independent of block count.
+class HeatmapRecorder {
+public:
+    HeatmapRecorder(size_t interval, size_t max_frames = 100000);
+
+    void tick(const Memory& mem);
+    void capture(const Memory& mem);
+
+    size_t frameCount() const { return frames.size(); }
+    bool writeCsv(const std::string& path) const;
+    bool writeBinary(const std::string& path) const;
+
+private:
+    size_t interval;
+    size_t max_frames;
+    uint64_t ops = 0;
+    size_t bucket_width = 0;
+    std::vector<HeatmapFrame> frames;
+};
+
+void printFailure(const AllocFailure& f);
+void printHeatmap(const Memory& mem);
+bool writeFailuresCsv(const Memory& mem, const std::string& path);
+
+#endif
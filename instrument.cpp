@@ -0,0 +1,76 @@
+#include "instrument.hpp"
+#include <algorithm>
+
+const char* probeName(Probe p) {
+    switch (p) {
+        case Probe::Allocate:           return "allocate";
+        case Probe::AllocateWithSelect: return "allocateWithSelect";
+        case Probe::Deallocate:         return "deallocate";
+        case Probe::Coalesce:           return "coalesce";
+        case Probe::CacheAccess:        return "cache_access";
+        default:                        return "unknown";
+    }
+}
+
+void LatencyHistogram::reset() {
+    std::fill(buckets, buckets + GROUPS * SUB_COUNT, 0);
+    total = sum = max_value = 0;
+    min_value = UINT64_MAX;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < GROUPS * SUB_COUNT; i++)
+        buckets[i] += other.buckets[i];
+    total += other.total;
+    sum += other.sum;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+}
+
+uint64_t LatencyHistogram::upperBoundOf(int index) {
+    if (index < SUB_COUNT)
+        return index;
+    int group = index / SUB_COUNT;
+    int sub = index % SUB_COUNT;
+    int msb = group + SUB_BITS - 1;
+    uint64_t width = 1ULL << (msb - SUB_BITS);
+    uint64_t low = (1ULL << msb) | ((uint64_t)sub << (msb - SUB_BITS));
+    return low + width - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0)
+        return 0;
+    uint64_t target = (uint64_t)(p / 100.0 * total);
+    if (target == 0)
+        target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < GROUPS * SUB_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= target)
+            return std::min(upperBoundOf(i), max_value);
+    }
+    return max_value;
+}
+
+// Per thread, so parallel replay workers never share counters
+Instrumentation& Instrumentation::get() {
+    static thread_local Instrumentation instance;
+    return instance;
+}
+
+void Instrumentation::reset() {
+    for (auto& h : latency)
+        h.reset();
+    blocks_scanned.reset();
+    splits = merges = 0;
+}
+
+void Instrumentation::mergeFrom(const Instrumentation& other) {
+    for (int p = 0; p < (int)Probe::Count; p++)
+        latency[p].merge(other.latency[p]);
+    blocks_scanned.merge(other.blocks_scanned);
+    splits += other.splits;
+    merges += other.merges;
+}
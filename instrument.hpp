@@ -0,0 +1,121 @@
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+#include <cstdint>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Hot-path probes. Build with SIM_INSTRUMENT (make INSTRUMENT=1) to record
+// them; by default (INSTRUMENT=0) every INSTR_* macro compiles to nothing.
+enum class Probe {
+    Allocate,
+    AllocateWithSelect,
+    Deallocate,
+    Coalesce,
+    CacheAccess,
+    Count
+};
+
+const char* probeName(Probe p);
+
+// Log-linear (HDR style) histogram: values below 16 are exact, larger values
+// fall into 16 linear sub-buckets per power of two (~6% relative error).
+class LatencyHistogram {
+public:
+    LatencyHistogram() { reset(); }
+
+    void record(uint64_t value) {
+        buckets[indexOf(value)]++;
+        total++;
+        sum += value;
+        if (value < min_value) min_value = value;
+        if (value > max_value) max_value = value;
+    }
+
+    void reset();
+    void merge(const LatencyHistogram& other);
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? min_value : 0; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return total ? (double)sum / total : 0.0; }
+    uint64_t percentile(double p) const;
+
+private:
+    static const int SUB_BITS = 4;
+    static const int SUB_COUNT = 1 << SUB_BITS;
+    static const int GROUPS = 64 - SUB_BITS + 1;
+
+    uint64_t buckets[GROUPS * SUB_COUNT];
+    uint64_t total, sum, min_value, max_value;
+
+    static int indexOf(uint64_t v) {
+        if (v < (uint64_t)SUB_COUNT)
+            return (int)v;
+        int msb = 63 - __builtin_clzll(v);
+        int group = msb - SUB_BITS + 1;
+        int sub = (int)((v >> (msb - SUB_BITS)) & (SUB_COUNT - 1));
+        return group * SUB_COUNT + sub;
+    }
+    static uint64_t upperBoundOf(int index);
+};
+
+struct Instrumentation {
+    LatencyHistogram latency[(int)Probe::Count];
+    LatencyHistogram blocks_scanned;    // Blocks visited per allocation
+    uint64_t splits = 0;
+    uint64_t merges = 0;
+
+    static Instrumentation& get();
+    void reset();
+    // Folds in another thread's counters (get() is per thread)
+    void mergeFrom(const Instrumentation& other);
+};
+
+// Cycle counter: TSC on x86, steady_clock nanoseconds elsewhere
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline const char* cycleUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "cycles";
+#else
+    return "ns";
+#endif
+}
+
+#ifdef SIM_INSTRUMENT
+class ProbeTimer {
+public:
+    explicit ProbeTimer(Probe p) : probe(p), start(readCycles()) {}
+    ~ProbeTimer() {
+        Instrumentation::get().latency[(int)probe].record(readCycles() - start);
+    }
+private:
+    Probe probe;
+    uint64_t start;
+};
+
+#define INSTR_CONCAT_(a, b) a##b
+#define INSTR_CONCAT(a, b) INSTR_CONCAT_(a, b)
+#define INSTR_TIME(probe) ProbeTimer INSTR_CONCAT(instr_timer_, __LINE__)(probe)
+#define INSTR_SCANNED(n) Instrumentation::get().blocks_scanned.record(n)
+#define INSTR_SPLIT() (Instrumentation::get().splits++)
+#define INSTR_MERGE() (Instrumentation::get().merges++)
+#define INSTR_ENABLED 1
+#else
+#define INSTR_TIME(probe) ((void)0)
+#define INSTR_SCANNED(n) ((void)0)
+#define INSTR_SPLIT() ((void)0)
+#define INSTR_MERGE() ((void)0)
+#define INSTR_ENABLED 0
+#endif
+
+#endif
@@ -2,16 +2,46 @@
 #include "allocator.hpp"
 #include "cache.hpp"
 #include "stats.hpp"
+#include "region.hpp"
+#include "snapshot.hpp"
+#include "compare.hpp"
+#include "diagnostics.hpp"
+#include "sampling.hpp"
+#include "coherence.hpp"
+#include "tracegen.hpp"
+#include "tiering.hpp"
+#include "ring.hpp"
+#include "trace.hpp"
+#include "instrument.hpp"
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <vector>
 #include <memory>
-#include <random>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
 
-// Global counters for cache statistics
-int L1_hits = 0, L1_misses = 0;
-int L2_hits = 0, L2_misses = 0;
+// Receives every access that misses the whole hierarchy during a tier command
+TieredMemory* tier_sink = nullptr;
+
+// Points tier_sink at the tiered memory for one tier command and charges that
+// command's cache traffic to it, so ordinary malloc/free traffic stays out of
+// the tier counters and keeps the batched L1 path
+struct TierScope
+{
+    TieredMemory& tiered;
+    StatsSnapshot before;
+
+    explicit TierScope(TieredMemory& t) : tiered(t), before(Stats::capture(0)) { tier_sink = &t; }
+    ~TierScope()
+    {
+        tier_sink = nullptr;
+        tiered.addCacheTraffic(before, Stats::capture(0));
+    }
+};
 
 // Function to simulate cache access during memory operations
 void simulateCacheAccess(
@@ -24,38 +54,342 @@ void simulateCacheAccess(
     if (caches.size() >= 1 && caches[0]) {
         caches[0]->access(address, hit);
         if (hit) {
-            L1_hits++;
+            Stats::level(0).hits++;
             return; // L1 hit, no need to go to L2
         }
-        L1_misses++;
+        Stats::level(0).misses++;
     }
     
     // Access L2 cache (if exists)
     if (caches.size() >= 2 && caches[1]) {
         caches[1]->access(address, hit);
         if (hit) {
-            L2_hits++;
+            Stats::level(1).hits++;
             // Bring block into L1 (write allocation policy)
             bool dummy;
             caches[0]->access(address, dummy);
             return;
         }
-        L2_misses++;
+        Stats::level(1).misses++;
     }
     
     // If no cache or cache miss, simulate memory access
-    // (Memory access latency could be simulated here)
+    if (tier_sink)
+        tier_sink->onMemoryAccess(address);
 }
 
-// Generate a random address within memory bounds for simulation
-uint64_t generateRandomAddress(size_t memory_size, size_t block_size) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, memory_size - block_size);
-    
-    // Align to block size
-    uint64_t addr = dis(gen);
-    return addr - (addr % block_size);
+// Batched equivalent of calling simulateCacheAccess() on each address. An
+// L1-only hierarchy goes through Cache::accessBatch; with an L2 the per-access
+// L1 refill order matters (and tiering needs each miss), so it falls back to
+// the serial path.
+void simulateCacheBatch(
+    std::vector<std::unique_ptr<Cache>>& caches,
+    const uint64_t* addresses,
+    size_t n
+) {
+    if (caches.empty() || !caches[0])
+        return;
+    if ((caches.size() >= 2 && caches[1]) || tier_sink) {
+        for (size_t i = 0; i < n; i++)
+            simulateCacheAccess(caches, addresses[i]);
+        return;
+    }
+    size_t hits = caches[0]->accessBatch(addresses, n, nullptr);
+    Stats::level(0).hits += hits;
+    Stats::level(0).misses += n - hits;
+}
+
+// Cache addresses a malloc touches: free list metadata, block header, zeroing
+void appendMallocPath(std::vector<uint64_t>& out, int id, size_t size, size_t block_size)
+{
+    // Simulate reading free list metadata (simulated address)
+    out.push_back(0x1000);
+
+    // Simulate writing block header (simulated address)
+    // We use a hash of the block ID as a simulated address
+    out.push_back(0x2000 + (id * 64));
+
+    // Simulate zeroing out the allocated memory
+    for (size_t i = 0; i < size; i += block_size)
+        out.push_back(0x3000 + (id * 256) + i);
+}
+
+// Cache addresses a free touches: block header read, free list update
+void appendFreePath(std::vector<uint64_t>& out, int id)
+{
+    out.push_back(0x2000 + (id * 64));
+    out.push_back(0x1000);
+}
+
+void touchMallocPath(std::vector<std::unique_ptr<Cache>>& caches, int id, size_t size)
+{
+    if (caches.empty() || !caches[0])
+        return;
+    static std::vector<uint64_t> addrs;
+    addrs.clear();
+    appendMallocPath(addrs, id, size, caches[0]->getBlockSize());
+    simulateCacheBatch(caches, addrs.data(), addrs.size());
+}
+
+void touchFreePath(std::vector<std::unique_ptr<Cache>>& caches, int id)
+{
+    if (caches.empty() || !caches[0])
+        return;
+    uint64_t addrs[2];
+    addrs[0] = 0x2000 + (id * 64);
+    addrs[1] = 0x1000;
+    simulateCacheBatch(caches, addrs, 2);
+}
+
+// Allocator side of a trace replay, shared by the serial and pipelined paths
+// so both make identical allocator calls and emit identical cache traffic.
+// With block_size 0 (no caches) no addresses are emitted.
+struct TraceApplier
+{
+    Memory& mem;
+    Allocator& alloc;
+    int& next_id;
+    size_t block_size;
+    TraceIdMap ids;
+    size_t failures = 0;
+
+    TraceApplier(Memory& mem, Allocator& alloc, int& next_id, size_t block_size)
+        : mem(mem), alloc(alloc), next_id(next_id), block_size(block_size) {}
+
+    void apply(const TraceEvent& ev, std::vector<uint64_t>& addresses)
+    {
+        if (ev.op == TraceOp::Malloc || ev.op == TraceOp::AlignedMalloc)
+        {
+            if (block_size)
+                appendMallocPath(addresses, next_id, ev.size, block_size);
+            Block *block = ev.op == TraceOp::Malloc
+                ? alloc.allocate(mem, ev.size, next_id)
+                : alloc.allocateAligned(mem, ev.size, ev.align, next_id);
+            if (block)
+                ids.allocated(ev, next_id++);
+            else
+                failures++;
+        }
+        else if (int id = ids.find(ev); id >= 0)
+        {
+            if (ev.op == TraceOp::Realloc)
+            {
+                if (block_size)
+                    appendMallocPath(addresses, id, ev.size, block_size);
+                if (!alloc.reallocate(mem, id, ev.size))
+                    failures++;
+            }
+            else
+            {
+                if (block_size)
+                    appendFreePath(addresses, id);
+                mem.deallocate(id);
+                ids.erase(ev);
+            }
+        }
+    }
+};
+
+size_t cacheBlockSize(const std::vector<std::unique_ptr<Cache>>& caches)
+{
+    return caches.empty() || !caches[0] ? 0 : caches[0]->getBlockSize();
+}
+
+// Replays a decoded trace through the active allocator exactly as the
+// equivalent typed malloc/free commands would, without per-event output.
+// With interval > 0, throughput and hit rates are printed every interval events.
+void replayTrace(const std::vector<TraceEvent>& trace, Memory& mem, Allocator& alloc,
+                 std::vector<std::unique_ptr<Cache>>& caches, int& next_id,
+                 HeatmapRecorder* heatmap, uint64_t interval = 0)
+{
+    TraceApplier applier{mem, alloc, next_id, cacheBlockSize(caches)};
+    std::vector<uint64_t> addresses;
+    uint64_t done = 0;
+    StatsSnapshot last = Stats::capture(0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (const TraceEvent& ev : trace)
+    {
+        addresses.clear();
+        applier.apply(ev, addresses);
+        simulateCacheBatch(caches, addresses.data(), addresses.size());
+        if (heatmap)
+            heatmap->tick(mem);
+        if (interval && ++done % interval == 0)
+        {
+            StatsSnapshot now = Stats::capture(done);
+            Stats::reportInterval(last, now);
+            last = now;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Replayed " << trace.size() << " events in " << seconds << " s ("
+              << (seconds > 0 ? trace.size() / seconds : 0.0) << " events/s), "
+              << applier.failures << " allocation failures" << std::endl;
+}
+
+// Cache addresses of a run of events. marks holds (addresses before the mark,
+// events replayed) at each interval boundary inside the batch.
+struct AddressBatch
+{
+    std::vector<uint64_t> addresses;
+    std::vector<std::pair<size_t, uint64_t>> marks;
+};
+
+// replayTrace() as a three-stage pipeline: decoding and the allocator run on
+// their own threads and the cache hierarchy on this one, linked by bounded
+// SPSC rings of batches. The allocator stage emits each event's addresses in
+// trace order, so the caches see exactly the serial access sequence and the
+// final memory, cache and tier state match replayTrace(). Throughput is
+// bounded by the slowest stage rather than by their sum.
+void replayTracePipelined(TraceReader& reader, Memory& mem, Allocator& alloc,
+                          std::vector<std::unique_ptr<Cache>>& caches, int& next_id,
+                          HeatmapRecorder* heatmap, uint64_t interval = 0)
+{
+    const size_t EVENTS_PER_BATCH = 4096;
+    const size_t RING_BATCHES = 16;
+    using Clock = std::chrono::steady_clock;
+
+    SpscRing<std::vector<TraceEvent>> decoded(RING_BATCHES);
+    SpscRing<AddressBatch> touched(RING_BATCHES);
+    TraceApplier applier{mem, alloc, next_id, cacheBlockSize(caches)};
+    uint64_t done = 0;
+    double decode_seconds = 0.0, alloc_seconds = 0.0, cache_seconds = 0.0;
+    // Probes are per thread; the stage threads hand theirs back on exit
+    Instrumentation decoder_instr, allocator_instr;
+
+    auto start = Clock::now();
+    std::thread decoder([&] {
+        for (;;)
+        {
+            std::vector<TraceEvent> events;
+            events.reserve(EVENTS_PER_BATCH);
+            auto t0 = Clock::now();
+            size_t n = reader.read(events, EVENTS_PER_BATCH);
+            decode_seconds += std::chrono::duration<double>(Clock::now() - t0).count();
+            if (n == 0)
+                break;
+            decoded.push(std::move(events));
+        }
+        decoded.close();
+        decoder_instr = Instrumentation::get();
+    });
+
+    std::thread allocator([&] {
+        std::vector<TraceEvent> events;
+        while (decoded.pop(events))
+        {
+            auto t0 = Clock::now();
+            AddressBatch batch;
+            for (const TraceEvent& ev : events)
+            {
+                applier.apply(ev, batch.addresses);
+                if (heatmap)
+                    heatmap->tick(mem);
+                if (interval && ++done % interval == 0)
+                    batch.marks.push_back({batch.addresses.size(), done});
+            }
+            if (!interval)
+                done += events.size();
+            alloc_seconds += std::chrono::duration<double>(Clock::now() - t0).count();
+            touched.push(std::move(batch));
+        }
+        touched.close();
+        allocator_instr = Instrumentation::get();
+    });
+
+    StatsSnapshot last = Stats::capture(0);
+    AddressBatch batch;
+    while (touched.pop(batch))
+    {
+        auto t0 = Clock::now();
+        size_t pos = 0;
+        for (const auto& [offset, events] : batch.marks)
+        {
+            simulateCacheBatch(caches, batch.addresses.data() + pos, offset - pos);
+            pos = offset;
+            StatsSnapshot now = Stats::capture(events);
+            Stats::reportInterval(last, now);
+            last = now;
+        }
+        simulateCacheBatch(caches, batch.addresses.data() + pos, batch.addresses.size() - pos);
+        cache_seconds += std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    decoder.join();
+    allocator.join();
+    Instrumentation::get().mergeFrom(decoder_instr);
+    Instrumentation::get().mergeFrom(allocator_instr);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "Replayed " << done << " events in " << seconds << " s ("
+              << (seconds > 0 ? done / seconds : 0.0) << " events/s), "
+              << applier.failures << " allocation failures" << std::endl;
+    std::cout << "Stage busy time: decode " << decode_seconds << " s, allocate " << alloc_seconds
+              << " s, cache " << cache_seconds << " s" << std::endl;
+}
+
+// Prints the diagnosis Memory recorded when the allocation failed, rather
+// than rescanning the heap. Nothing is printed if no failure was recorded
+// since `failures_before` (e.g. buddy, whose blocks live outside Memory).
+void printLastFailure(const Memory& mem, size_t failures_before)
+{
+    if (mem.getFailureCount() > failures_before && mem.getLastFailure())
+        printFailure(*mem.getLastFailure());
+}
+
+// Parses a whole token as an integer > 0: no sign, no suffix, no overflow
+bool parsePositive(const std::string& token, uint64_t& value)
+{
+    if (token.empty() || !std::isdigit(static_cast<unsigned char>(token[0])))
+        return false;
+    try
+    {
+        size_t used;
+        value = std::stoull(token, &used);
+        return used == token.size() && value > 0;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+// Reads "[model] [seed]" / "[model] [verify]" style tails: a model name
+// selects the locality model, a number sets the seed, anything else is a
+// flag. A seed that is not a whole 64-bit number sets error.
+TraceGenConfig readTraceOptions(std::istringstream& iss, size_t memory_size, size_t block_size,
+                                std::vector<std::string>& flags, std::string& error,
+                                TraceModel model = TraceModel::Uniform)
+{
+    TraceGenConfig cfg;
+    cfg.model = model;
+    cfg.footprint = memory_size;
+    cfg.block_size = block_size;
+
+    std::string word;
+    while (iss >> word)
+    {
+        if (parseTraceModel(word, cfg.model))
+            continue;
+        if (!word.empty() && std::isdigit(static_cast<unsigned char>(word[0])))
+        {
+            try
+            {
+                size_t used;
+                cfg.seed = std::stoull(word, &used);
+                if (used != word.size())
+                    error = "Invalid seed " + word;
+            }
+            catch (const std::exception&)
+            {
+                error = "Invalid seed " + word;
+            }
+        }
+        else
+            flags.push_back(word);
+    }
+    return cfg;
 }
 
 int main()
@@ -63,10 +397,14 @@ int main()
     std::unique_ptr<Memory> mem;
     std::unique_ptr<Allocator> alloc;
     std::vector<std::unique_ptr<Cache>> caches;
+    std::unique_ptr<RegionManager> regions;
+    std::unique_ptr<HeatmapRecorder> heatmap;
+    std::unique_ptr<CoherentSystem> coherent;
+    std::unique_ptr<TieredMemory> tiered;
     int next_id = 1;
     
     // Reset global counters
-    L1_hits = L1_misses = L2_hits = L2_misses = 0;
+    Stats::resetLevels();
 
     std::cout << "Memory Management Simulator CLI" << std::endl;
     std::cout << "Type 'help' for commands or 'exit' to quit." << std::endl;
@@ -86,14 +424,54 @@ int main()
             std::cout << "  init memory <size>" << std::endl;
             std::cout << "  set allocator <first_fit|best_fit|worst_fit>" << std::endl;
             std::cout << "  malloc <size>" << std::endl;
+            std::cout << "  realloc <id> <size>" << std::endl;
+            std::cout << "  memalign <align> <size>" << std::endl;
             std::cout << "  free <id>" << std::endl;
             std::cout << "  dump memory" << std::endl;
-            std::cout << "  stats" << std::endl;
+            std::cout << "  dump failures [csv_file]    # Allocation failure analysis" << std::endl;
+            std::cout << "  heatmap start <buckets> <every_n_ops>" << std::endl;
+            std::cout << "  heatmap show" << std::endl;
+            std::cout << "  heatmap export <file> [csv|bin]" << std::endl;
+            std::cout << "  stats [--latency|--json]" << std::endl;
             std::cout << "  init cache <level> <size> <block_size> <associativity> <policy>" << std::endl;
+            std::cout << "      policy: LRU LFU FIFO PLRU BIT_PLRU SRRIP BRRIP DRRIP ARC RANDOM" << std::endl;
             std::cout << "  cache read <hex_address>    # Test cache read" << std::endl;
             std::cout << "  cache write <hex_address>   # Test cache write" << std::endl;
             std::cout << "  cache stats                 # Detailed cache stats" << std::endl;
-            std::cout << "  cache test <num_accesses>   # Generate random cache accesses" << std::endl;
+            std::cout << "  cache sets <level> [top_n]  # Per-set hits/misses/evictions" << std::endl;
+            std::cout << "  cache test <num_accesses> [model] [seed]" << std::endl;
+            std::cout << "      model: uniform sequential strided zipf chase mixed (default uniform, seed 1)" << std::endl;
+            std::cout << "  cache sample <accesses> <period> <sample_len> <warmup> [model] [seed] [file <path>] [verify]" << std::endl;
+            std::cout << "                              # Sampled simulation (warmup 0 = warm all)" << std::endl;
+            std::cout << "  cache save-trace <file> <accesses> [model] [seed]" << std::endl;
+            std::cout << "                              # Binary address trace for 'cache sample ... file'" << std::endl;
+            std::cout << "  cache compare <size> <block_size> <assoc> <accesses> [policy,...]" << std::endl;
+            std::cout << "                              # Policies on scan- and loop-heavy streams" << std::endl;
+            std::cout << "  region create <chunk_size>" << std::endl;
+            std::cout << "  region malloc <region> <size>" << std::endl;
+            std::cout << "  region keep <object>        # Promote object when its region is freed" << std::endl;
+            std::cout << "  region free <region>        # Bulk free (region 0 = old generation)" << std::endl;
+            std::cout << "  region stats" << std::endl;
+            std::cout << "  region bench <objects> <size>" << std::endl;
+            std::cout << "  snapshot save <file>        # Memory, allocator and caches" << std::endl;
+            std::cout << "  snapshot load <file>" << std::endl;
+            std::cout << "  trace replay <trace_file> [interval]" << std::endl;
+            std::cout << "                              # CLI script or libmmtrace.so capture; per-interval stats" << std::endl;
+            std::cout << "  trace pipeline <trace_file> [interval]" << std::endl;
+            std::cout << "                              # Same results; decode/allocate/cache stages on own threads" << std::endl;
+            std::cout << "  compare <trace_file> <heap[,heap...]> [strategy,...] [threads]" << std::endl;
+            std::cout << "  coherence init <cores> <l1_size> <block_size> <l1_assoc> <l2_size> <l2_assoc> <policy> [mesi|moesi]" << std::endl;
+            std::cout << "  coherence test <ops_per_core> <false_sharing|private|shared_read|migratory>" << std::endl;
+            std::cout << "  coherence run <core0_trace> [core1_trace...]" << std::endl;
+            std::cout << "  coherence stats" << std::endl;
+            std::cout << "  tier init <fast_size> <fast_ns> <slow_size> <slow_ns> <policy> [page_size] [epoch]" << std::endl;
+            std::cout << "      policy: fast_first slow_first small_fast interleave" << std::endl;
+            std::cout << "  tier malloc <size>" << std::endl;
+            std::cout << "  tier free <id>" << std::endl;
+            std::cout << "  tier access <id> <offset>   # Through the caches; misses drive migration" << std::endl;
+            std::cout << "  tier bench <objects> <size> <accesses> [model] [seed]" << std::endl;
+            std::cout << "  tier migrate                # Run a migration pass now" << std::endl;
+            std::cout << "  tier stats                  # AMAT and migration traffic" << std::endl;
             std::cout << "  exit" << std::endl;
         }
         else if (cmd == "init" && iss >> cmd)
@@ -104,8 +482,10 @@ int main()
                 if (iss >> size)
                 {
                     mem = std::make_unique<Memory>(size);
+                    regions = std::make_unique<RegionManager>();
+                    heatmap.reset();
                     // Reset cache counters when memory is reinitialized
-                    L1_hits = L1_misses = L2_hits = L2_misses = 0;
+                    Stats::resetLevels();
                     std::cout << "Memory initialized with size " << size << std::endl;
                 }
                 else
@@ -117,23 +497,24 @@ int main()
                 size_t size, block_size;
                 int associativity;
                 std::string policy;
+                ReplacementPolicy kind;
                 if (iss >> level >> size >> block_size >> associativity >> policy)
                 {
-                    if (level >= 1 && level <= 3)
+                    if (level < 1 || level > 3)
+                        std::cout << "Error: Invalid cache level (1-3)" << std::endl;
+                    else if (!Cache::validGeometry(size, block_size, associativity))
+                        std::cout << "Error: Cache must hold at least one set (size >= block_size * assoc)" << std::endl;
+                    else if (!parsePolicy(policy, kind))
+                        std::cout << "Error: Unknown replacement policy " << policy << std::endl;
+                    else
                     {
                         while (static_cast<int>(caches.size()) < level)
                             caches.emplace_back(nullptr);
                         caches[level - 1] = std::make_unique<Cache>(size, block_size, associativity, policy);
                         std::cout << "Cache L" << level << " initialized" << std::endl;
                         // Reset counters for this cache level
-                        if (level == 1) {
-                            L1_hits = L1_misses = 0;
-                        } else if (level == 2) {
-                            L2_hits = L2_misses = 0;
-                        }
+                        Stats::level(level - 1) = LevelCounters();
                     }
-                    else
-                        std::cout << "Error: Invalid cache level (1-3)" << std::endl;
                 }
                 else
                     std::cout << "Error: Invalid cache parameters" << std::endl;
@@ -148,19 +529,13 @@ int main()
                 std::string type;
                 if (iss >> type && mem)
                 {
-                    if (type == "first_fit")
-                        alloc = std::make_unique<FirstFit>();
-                    else if (type == "best_fit")
-                        alloc = std::make_unique<BestFit>();
-                    else if (type == "worst_fit")
-                        alloc = std::make_unique<WorstFit>();
-                    else if (type == "buddy")
-                        alloc = std::make_unique<BuddyAllocator>(mem->getTotalSize());
-                    else
+                    std::unique_ptr<Allocator> next = createAllocator(type, mem->getTotalSize());
+                    if (!next)
                     {
                         std::cout << "Error: Unknown allocator type" << std::endl;
                         continue;
                     }
+                    alloc = std::move(next);
                     std::cout << "Allocator set to " << type << std::endl;
                 }
                 else
@@ -175,22 +550,9 @@ int main()
             if (iss >> size && mem && alloc)
             {
                 // Simulate cache accesses during allocation
-                if (caches.size() >= 1 && caches[0]) {
-                    // Simulate reading free list metadata (simulated address)
-                    simulateCacheAccess(caches, 0x1000);
-                    
-                    // Simulate writing block header (simulated address)
-                    // We use a hash of the block ID as a simulated address
-                    uint64_t header_addr = 0x2000 + (next_id * 64);
-                    simulateCacheAccess(caches, header_addr);
-                    
-                    // Simulate zeroing out the allocated memory
-                    for (size_t i = 0; i < size; i += caches[0]->getBlockSize()) {
-                        uint64_t data_addr = 0x3000 + (next_id * 256) + i;
-                        simulateCacheAccess(caches, data_addr);
-                    }
-                }
+                touchMallocPath(caches, next_id, size);
                 
+                size_t failed = mem->getFailureCount();
                 Block *block = alloc->allocate(*mem, size, next_id);
                 if (block)
                 {
@@ -200,7 +562,69 @@ int main()
                     ++next_id;
                 }
                 else
+                {
                     std::cout << "Allocation failed" << std::endl;
+                    printLastFailure(*mem, failed);
+                }
+                if (heatmap)
+                    heatmap->tick(*mem);
+            }
+            else
+                std::cout << "Error: Initialize memory and allocator first" << std::endl;
+        }
+        else if (cmd == "realloc")
+        {
+            int id;
+            size_t size;
+            if (iss >> id >> size && mem && alloc && id >= RegionManager::FIRST_CHUNK_ID)
+                std::cout << "Error: Block " << id << " backs a region" << std::endl;
+            else if (mem && alloc && !iss.fail() && !mem->isAllocated(id))
+                std::cout << "Error: Unknown block id " << id << std::endl;
+            else if (mem && alloc && !iss.fail() && size == 0)
+                std::cout << "Error: Invalid size" << std::endl;
+            else if (mem && alloc && !iss.fail())
+            {
+                size_t in_place = mem->getReallocInPlace();
+                size_t failed = mem->getFailureCount();
+                touchMallocPath(caches, id, size);
+                Block *block = alloc->reallocate(*mem, id, size);
+                if (!block)
+                {
+                    std::cout << "Reallocation failed" << std::endl;
+                    printLastFailure(*mem, failed);
+                }
+                else
+                    std::cout << "Block " << id << " resized to " << size
+                              << (mem->getReallocInPlace() > in_place ? " in place" : " (moved)") << std::endl;
+                if (heatmap)
+                    heatmap->tick(*mem);
+            }
+            else
+                std::cout << "Error: Initialize memory and allocator first" << std::endl;
+        }
+        else if (cmd == "memalign")
+        {
+            size_t align, size;
+            if (iss >> align >> size && mem && alloc)
+            {
+                touchMallocPath(caches, next_id, size);
+                size_t failed = mem->getFailureCount();
+                Block *block = alloc->allocateAligned(*mem, size, align, next_id);
+                if (block)
+                {
+                    std::cout << "Allocated block id=" << next_id
+                              << " aligned to " << align << std::endl;
+                    ++next_id;
+                }
+                else if (align == 0 || (align & (align - 1)) != 0)
+                    std::cout << "Error: Alignment must be a power of two" << std::endl;
+                else
+                {
+                    std::cout << "Allocation failed" << std::endl;
+                    printLastFailure(*mem, failed);
+                }
+                if (heatmap)
+                    heatmap->tick(*mem);
             }
             else
                 std::cout << "Error: Initialize memory and allocator first" << std::endl;
@@ -208,19 +632,16 @@ int main()
         else if (cmd == "free")
         {
             int id;
-            if (iss >> id && mem)
+            if (iss >> id && mem && id >= RegionManager::FIRST_CHUNK_ID)
+                std::cout << "Error: Block " << id << " backs a region; use region free" << std::endl;
+            else if (mem && !iss.fail())
             {
                 // Simulate cache accesses during deallocation
-                if (caches.size() >= 1 && caches[0]) {
-                    // Simulate reading block header
-                    uint64_t header_addr = 0x2000 + (id * 64);
-                    simulateCacheAccess(caches, header_addr);
-                    
-                    // Simulate writing free list update
-                    simulateCacheAccess(caches, 0x1000);
-                }
+                touchFreePath(caches, id);
                 
                 mem->deallocate(id);
+                if (heatmap)
+                    heatmap->tick(*mem);
                 std::cout << "Block " << id << " freed and merged" << std::endl;
             }
             else
@@ -228,35 +649,52 @@ int main()
         }
         else if (cmd == "dump" && iss >> cmd)
         {
-            if (cmd == "memory" && mem)
+            std::string path;
+            if (!mem)
+                std::cout << "Error: Initialize memory first" << std::endl;
+            else if (cmd == "memory")
                 mem->dump();
+            else if (cmd == "failures" && iss >> path)
+            {
+                if (writeFailuresCsv(*mem, path))
+                    std::cout << mem->getFailures().size() << " failures written to " << path << std::endl;
+                else
+                    std::cout << "Error: Could not write " << path << std::endl;
+            }
+            else if (cmd == "failures")
+            {
+                for (const AllocFailure &f : mem->getFailures())
+                {
+                    std::cout << "Request #" << f.request_index << ":" << std::endl;
+                    printFailure(f);
+                }
+                std::cout << mem->getFailures().size() << " recorded failures" << std::endl;
+            }
             else
-                std::cout << "Error: Initialize memory first" << std::endl;
+                std::cout << "Error: Unknown dump subcommand" << std::endl;
         }
         else if (cmd == "stats")
         {
+            std::string opt;
+            iss >> opt;
+            if (opt == "--latency")
+            {
+                Stats::reportLatency();
+                continue;
+            }
+            if (opt == "--json")
+            {
+                Stats::reportJson(mem.get());
+                continue;
+            }
+
             if (mem)
                 Stats::report(*mem);
             else
                 std::cout << "Error: Initialize memory first" << std::endl;
             
             // Show cache statistics
-            std::cout << "\n===== Cache Statistics =====\n";
-            if (caches.size() >= 1 && caches[0]) {
-                std::cout << "L1 Cache Hits: " << L1_hits << std::endl;
-                std::cout << "L1 Cache Misses: " << L1_misses << std::endl;
-                int L1_total = L1_hits + L1_misses;
-                double L1_hit_rate = (L1_total > 0) ? (double)L1_hits / L1_total * 100.0 : 0.0;
-                std::cout << "L1 Hit Rate: " << L1_hit_rate << "%" << std::endl;
-            }
-            if (caches.size() >= 2 && caches[1]) {
-                std::cout << "L2 Cache Hits: " << L2_hits << std::endl;
-                std::cout << "L2 Cache Misses: " << L2_misses << std::endl;
-                int L2_total = L2_hits + L2_misses;
-                double L2_hit_rate = (L2_total > 0) ? (double)L2_hits / L2_total * 100.0 : 0.0;
-                std::cout << "L2 Hit Rate: " << L2_hit_rate << "%" << std::endl;
-            }
-            std::cout << "==============================\n";
+            Stats::reportHierarchy(caches);
         }
         else if (cmd == "cache" && iss >> cmd)
         {
@@ -289,26 +727,603 @@ int main()
                 }
             }
             else if (cmd == "test") {
-                int num_accesses;
+                uint64_t num_accesses;
                 if (iss >> num_accesses && mem && !caches.empty() && caches[0]) {
-                    std::cout << "Generating " << num_accesses << " random cache accesses..." << std::endl;
-                    for (int i = 0; i < num_accesses; i++) {
-                        uint64_t addr = generateRandomAddress(mem->getTotalSize(), caches[0]->getBlockSize());
-                        simulateCacheAccess(caches, addr);
+                    std::vector<std::string> flags;
+                    std::string error;
+                    TraceGenerator gen(readTraceOptions(iss, mem->getTotalSize(), caches[0]->getBlockSize(), flags, error));
+                    if (error.empty() && !flags.empty())
+                        error = "Unknown trace model " + flags[0];
+                    if (!error.empty()) {
+                        std::cout << "Error: " << error << std::endl;
+                        continue;
+                    }
+                    std::cout << "Generating " << num_accesses << " " << traceModelName(gen.getConfig().model)
+                              << " cache accesses (seed " << gen.getConfig().seed << ")..." << std::endl;
+
+                    std::vector<uint64_t> batch(4096);
+                    double gen_seconds = 0.0, sim_seconds = 0.0;
+                    for (uint64_t done = 0; done < num_accesses; done += batch.size()) {
+                        size_t n = static_cast<size_t>(std::min<uint64_t>(batch.size(), num_accesses - done));
+                        auto t0 = std::chrono::steady_clock::now();
+                        gen.generate(batch.data(), n);
+                        auto t1 = std::chrono::steady_clock::now();
+                        simulateCacheBatch(caches, batch.data(), n);
+                        gen_seconds += std::chrono::duration<double>(t1 - t0).count();
+                        sim_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+                    }
+                    std::cout << "Cache test completed (generation " << gen_seconds * 1000
+                              << " ms, simulation " << sim_seconds * 1000 << " ms)." << std::endl;
+                } else {
+                    std::cout << "Error: Initialize memory and cache first" << std::endl;
+                }
+            }
+            else if (cmd == "sample") {
+                SamplingConfig cfg;
+                if (iss >> cfg.accesses >> cfg.period >> cfg.sample >> cfg.warmup && cfg.period > 0
+                    && mem && !caches.empty() && caches[0]) {
+                    std::vector<std::string> flags;
+                    std::string path, error;
+                    TraceGenConfig trace_cfg = readTraceOptions(iss, mem->getTotalSize(), caches[0]->getBlockSize(), flags, error);
+                    bool verify = false;
+                    for (size_t i = 0; i < flags.size() && error.empty(); i++) {
+                        if (flags[i] == "verify")
+                            verify = true;
+                        else if (flags[i] == "file" && i + 1 < flags.size())
+                            path = flags[++i];
+                        else
+                            error = "Unknown trace model " + flags[i];
+                    }
+                    if (!error.empty()) {
+                        std::cout << "Error: " << error << std::endl;
+                        continue;
+                    }
+
+                    // A file source is opened twice so the reference run replays it from the start
+                    std::unique_ptr<AddressSource> source, full_source;
+                    if (path.empty()) {
+                        source = std::make_unique<TraceGenerator>(trace_cfg);
+                        full_source = std::make_unique<TraceGenerator>(trace_cfg);
+                    } else {
+                        auto file = std::make_unique<AddressFileSource>();
+                        auto full_file = std::make_unique<AddressFileSource>();
+                        if (!file->open(path) || !full_file->open(path)) {
+                            std::cout << "Error: Could not open address trace " << path << std::endl;
+                            continue;
+                        }
+                        cfg.accesses = std::min<uint64_t>(cfg.accesses, file->size());
+                        source = std::move(file);
+                        full_source = std::move(full_file);
+                    }
+
+                    // Keep an untouched copy of the hierarchy for the reference run
+                    std::vector<std::unique_ptr<Cache>> reference;
+                    if (verify)
+                        for (const auto& c : caches)
+                            reference.push_back(c ? std::make_unique<Cache>(*c) : nullptr);
+
+                    SamplingResult sampled = runSampled(caches, *source, cfg);
+                    printSampling(sampled, "Sampled Simulation");
+
+                    if (verify) {
+                        SamplingResult full = runFull(reference, *full_source, sampled.samples * cfg.period);
+                        printSampling(full, "Full Simulation");
+                        printSamplingSpeedup(sampled, full);
                     }
-                    std::cout << "Cache test completed." << std::endl;
                 } else {
                     std::cout << "Error: Initialize memory and cache first" << std::endl;
                 }
             }
+            else if (cmd == "save-trace") {
+                std::string path;
+                uint64_t accesses;
+                if (iss >> path >> accesses && mem && !caches.empty() && caches[0]) {
+                    std::vector<std::string> flags;
+                    std::string error;
+                    TraceGenConfig trace_cfg = readTraceOptions(iss, mem->getTotalSize(), caches[0]->getBlockSize(), flags, error);
+                    if (error.empty() && !flags.empty())
+                        error = "Unknown trace model " + flags[0];
+                    if (!error.empty()) {
+                        std::cout << "Error: " << error << std::endl;
+                        continue;
+                    }
+                    TraceGenerator gen(trace_cfg);
+                    if (writeAddressTrace(path, gen, accesses))
+                        std::cout << "Wrote " << accesses << " addresses to " << path << std::endl;
+                    else
+                        std::cout << "Error: Could not write " << path << std::endl;
+                } else {
+                    std::cout << "Error: Usage cache save-trace <file> <accesses> [model] [seed] (initialize memory and cache first)" << std::endl;
+                }
+            }
+            else if (cmd == "sets") {
+                int level;
+                size_t top = 10;
+                std::string top_arg;
+                uint64_t parsed;
+                if (iss >> level && level >= 1 && level <= static_cast<int>(caches.size()) && caches[level - 1]) {
+                    if (iss >> top_arg && !parsePositive(top_arg, parsed)) {
+                        std::cout << "Error: Invalid top_n " << top_arg << std::endl;
+                        continue;
+                    }
+                    if (!top_arg.empty())
+                        top = static_cast<size_t>(parsed);
+                    Stats::reportSets(*caches[level - 1], top);
+                } else {
+                    std::cout << "Error: Initialize cache level first" << std::endl;
+                }
+            }
+            else if (cmd == "compare") {
+                size_t size, block_size, accesses;
+                int associativity;
+                std::string list = "LRU,LFU,FIFO,PLRU,BIT_PLRU,SRRIP,BRRIP,DRRIP,ARC,RANDOM";
+                if (iss >> size >> block_size >> associativity >> accesses && block_size > 0 && associativity > 0) {
+                    iss >> list;
+                    std::vector<std::string> policies;
+                    std::string item, error;
+                    std::istringstream policy_list(list);
+                    ReplacementPolicy kind;
+                    while (error.empty() && std::getline(policy_list, item, ','))
+                        if (!item.empty() && !parsePolicy(item, kind))
+                            error = "Unknown replacement policy " + item;
+                        else if (!item.empty())
+                            policies.push_back(item);
+                    if (error.empty() && !Cache::validGeometry(size, block_size, associativity))
+                        error = "Cache must hold at least one set (size >= block_size * assoc)";
+                    if (!error.empty()) {
+                        std::cout << "Error: " << error << std::endl;
+                        continue;
+                    }
+                    printPolicyComparison(runPolicyComparison(size, block_size, associativity, policies, accesses), accesses);
+                } else {
+                    std::cout << "Error: Usage cache compare <size> <block_size> <assoc> <accesses> [policy,...]" << std::endl;
+                }
+            }
             else {
                 std::cout << "Error: Unknown cache command" << std::endl;
             }
         }
+        else if (cmd == "region" && iss >> cmd)
+        {
+            if (cmd == "bench")
+            {
+                size_t count, size;
+                if (iss >> count >> size && count > 0 && size > 0)
+                    RegionManager::benchmark(count, size);
+                else
+                    std::cout << "Error: Invalid benchmark parameters" << std::endl;
+            }
+            else if (!mem || !alloc || !regions)
+                std::cout << "Error: Initialize memory and allocator first" << std::endl;
+            else if (!alloc->ownsMemoryBlocks())
+                std::cout << "Error: Regions need a list allocator (" << alloc->name() << " blocks are not in Memory)" << std::endl;
+            else if (cmd == "create")
+            {
+                size_t chunk_size;
+                if (iss >> chunk_size && chunk_size > 0)
+                    std::cout << "Region " << regions->create(chunk_size) << " created" << std::endl;
+                else
+                    std::cout << "Error: Invalid chunk size" << std::endl;
+            }
+            else if (cmd == "malloc")
+            {
+                int region;
+                size_t size;
+                if (iss >> region >> size)
+                {
+                    int obj = regions->allocate(*mem, *alloc, region, size);
+                    if (obj >= 0)
+                    {
+                        const RegionObject *o = regions->find(obj);
+                        std::cout << "Allocated object id=" << obj << " in region " << region
+                                  << " (chunk " << o->chunk << ", offset " << o->offset << ")" << std::endl;
+                    }
+                    else
+                        std::cout << "Allocation failed" << std::endl;
+                }
+                else
+                    std::cout << "Error: Invalid region parameters" << std::endl;
+            }
+            else if (cmd == "keep")
+            {
+                int obj;
+                if (iss >> obj && regions->markSurvivor(obj))
+                    std::cout << "Object " << obj << " marked as survivor" << std::endl;
+                else
+                    std::cout << "Error: Unknown object" << std::endl;
+            }
+            else if (cmd == "free")
+            {
+                int region;
+                size_t dropped = regions->getDroppedSurvivors();
+                if (iss >> region && regions->release(*mem, *alloc, region))
+                {
+                    std::cout << "Region " << region << " freed" << std::endl;
+                    if (regions->getDroppedSurvivors() > dropped)
+                        std::cout << "Error: " << regions->getDroppedSurvivors() - dropped
+                                  << " survivors could not be promoted (old generation out of memory)" << std::endl;
+                }
+                else
+                    std::cout << "Error: Unknown region" << std::endl;
+            }
+            else if (cmd == "stats")
+                regions->report();
+            else
+                std::cout << "Error: Unknown region command" << std::endl;
+        }
+        else if (cmd == "heatmap" && iss >> cmd)
+        {
+            if (!mem)
+                std::cout << "Error: Initialize memory first" << std::endl;
+            else if (cmd == "start")
+            {
+                size_t buckets, interval;
+                if (iss >> buckets >> interval && buckets > 0 && interval > 0)
+                {
+                    mem->enableHeatmap(buckets);
+                    heatmap = std::make_unique<HeatmapRecorder>(interval);
+                    heatmap->capture(*mem);
+                    std::cout << "Heatmap recording every " << interval << " ops" << std::endl;
+                }
+                else
+                    std::cout << "Error: Invalid heatmap parameters" << std::endl;
+            }
+            else if (!heatmap)
+                std::cout << "Error: Start the heatmap first" << std::endl;
+            else if (cmd == "show")
+                printHeatmap(*mem);
+            else if (cmd == "export")
+            {
+                std::string path, format = "csv";
+                iss >> path >> format;
+                bool ok = !path.empty() && (format == "bin" ? heatmap->writeBinary(path) : heatmap->writeCsv(path));
+                if (ok)
+                    std::cout << heatmap->frameCount() << " frames written to " << path << std::endl;
+                else
+                    std::cout << "Error: Could not write heatmap" << std::endl;
+            }
+            else
+                std::cout << "Error: Unknown heatmap command" << std::endl;
+        }
+        else if (cmd == "snapshot" && iss >> cmd)
+        {
+            std::string path;
+            if (!(iss >> path))
+                std::cout << "Error: Missing snapshot file" << std::endl;
+            else if (cmd == "save")
+            {
+                if (!mem)
+                    std::cout << "Error: Initialize memory first" << std::endl;
+                else if (Snapshot::save(path, *mem, alloc.get(), caches,
+                                        {next_id,
+                                         static_cast<int64_t>(Stats::level(0).hits),
+                                         static_cast<int64_t>(Stats::level(0).misses),
+                                         static_cast<int64_t>(Stats::level(1).hits),
+                                         static_cast<int64_t>(Stats::level(1).misses)}))
+                    std::cout << "Snapshot saved to " << path << std::endl;
+                else
+                    std::cout << "Error: Could not write " << path << std::endl;
+            }
+            else if (cmd == "load")
+            {
+                std::vector<int64_t> counters;
+                if (Snapshot::load(path, mem, alloc, caches, counters, 5))
+                {
+                    next_id = static_cast<int>(counters[0]);
+                    Stats::resetLevels();
+                    Stats::level(0).hits = static_cast<uint64_t>(counters[1]);
+                    Stats::level(0).misses = static_cast<uint64_t>(counters[2]);
+                    Stats::level(1).hits = static_cast<uint64_t>(counters[3]);
+                    Stats::level(1).misses = static_cast<uint64_t>(counters[4]);
+                    // Region bookkeeping is not part of the snapshot: release the
+                    // saved chunks so new chunk ids cannot collide with them
+                    std::vector<int> chunks;
+                    for (const Block *b = mem->getHead(); b; b = b->next)
+                        if (!b->free && b->id >= RegionManager::FIRST_CHUNK_ID)
+                            chunks.push_back(b->id);
+                    for (int id : chunks)
+                        mem->deallocate(id);
+                    if (!chunks.empty())
+                        std::cout << "Released " << chunks.size() << " region chunks (regions are not saved)" << std::endl;
+                    regions = std::make_unique<RegionManager>();
+                    heatmap.reset();
+                    std::cout << "Snapshot loaded from " << path << std::endl;
+                }
+                else
+                    std::cout << "Error: Invalid snapshot " << path << std::endl;
+            }
+            else
+                std::cout << "Error: Unknown snapshot command" << std::endl;
+        }
+        else if (cmd == "trace" && iss >> cmd)
+        {
+            std::string path, interval_arg;
+            uint64_t interval = 0;
+            std::vector<TraceEvent> trace;
+            TraceReader reader;
+            if ((cmd != "replay" && cmd != "pipeline") || !(iss >> path))
+                std::cout << "Error: Usage trace replay|pipeline <trace_file> [interval]" << std::endl;
+            else if (iss >> interval_arg && !parsePositive(interval_arg, interval))
+                std::cout << "Error: Invalid interval " << interval_arg << " (must be a positive number)" << std::endl;
+            else if (!mem || !alloc)
+                std::cout << "Error: Initialize memory and allocator first" << std::endl;
+            else if (cmd == "pipeline" && reader.open(path))
+            {
+                replayTracePipelined(reader, *mem, *alloc, caches, next_id, heatmap.get(), interval);
+            }
+            else if (cmd == "pipeline" || !loadTrace(path, trace))
+                std::cout << "Error: Could not read " << path << std::endl;
+            else
+            {
+                replayTrace(trace, *mem, *alloc, caches, next_id, heatmap.get(), interval);
+            }
+        }
+        else if (cmd == "compare")
+        {
+            std::string path, heaps_arg, strategies_arg = "first_fit,best_fit,worst_fit";
+            unsigned threads = 0;
+            if (!(iss >> path >> heaps_arg))
+            {
+                std::cout << "Error: Usage compare <trace_file> <heap[,heap...]>" << std::endl;
+                continue;
+            }
+            iss >> strategies_arg >> threads;
+
+            std::vector<size_t> heaps;
+            std::vector<std::string> strategies;
+            std::string item, error;
+            std::istringstream heap_list(heaps_arg), strategy_list(strategies_arg);
+            while (error.empty() && std::getline(heap_list, item, ','))
+            {
+                uint64_t heap;
+                if (parsePositive(item, heap))
+                    heaps.push_back(heap);
+                else
+                    error = "Invalid heap size " + item;
+            }
+            while (error.empty() && std::getline(strategy_list, item, ','))
+            {
+                // Utilisation, fragmentation and frees are measured on
+                // Memory's list, so strategies that keep blocks elsewhere
+                // cannot be compared
+                std::unique_ptr<Allocator> probe = createAllocator(item, 1);
+                if (!probe)
+                    error = "Unknown strategy " + item;
+                else if (!probe->ownsMemoryBlocks())
+                    error = "compare does not support " + item;
+                else
+                    strategies.push_back(item);
+            }
+            if (error.empty() && (heaps.empty() || strategies.empty()))
+                error = "Empty heap or strategy list";
+            if (!error.empty())
+            {
+                std::cout << "Error: " << error << std::endl;
+                continue;
+            }
+
+            std::vector<TraceEvent> trace;
+            if (!loadTrace(path, trace))
+            {
+                std::cout << "Error: Could not read " << path << std::endl;
+                continue;
+            }
+
+            printComparison(runComparison(trace, strategies, heaps, threads), trace.size());
+        }
+        else if (cmd == "tier" && iss >> cmd)
+        {
+            if (cmd == "init")
+            {
+                TierConfig cfg;
+                std::string policy;
+                if (iss >> cfg.fast_size >> cfg.fast_ns >> cfg.slow_size >> cfg.slow_ns >> policy
+                    && parseTierPolicy(policy, cfg.policy))
+                {
+                    iss >> cfg.page_size >> cfg.epoch;
+                    if (alloc)
+                        cfg.allocator = alloc->name();
+                    tiered = std::make_unique<TieredMemory>(cfg);
+                    if (cfg.allocator != tiered->getConfig().allocator)
+                        std::cout << "Note: tiering needs a list allocator, using "
+                                  << tiered->getConfig().allocator << " instead of " << cfg.allocator << std::endl;
+                    std::cout << "Tiered memory initialized (" << policy << ", allocator "
+                              << tiered->getConfig().allocator << ")" << std::endl;
+                }
+                else
+                    std::cout << "Error: Invalid tier parameters" << std::endl;
+            }
+            else if (!tiered)
+                std::cout << "Error: Initialize tiered memory first" << std::endl;
+            else if (cmd == "malloc")
+            {
+                size_t size;
+                int tier;
+                if (!(iss >> size))
+                    std::cout << "Error: Invalid size" << std::endl;
+                else if ((tier = tiered->allocate(size, next_id)) < 0)
+                    std::cout << "Error: Both tiers are full" << std::endl;
+                else
+                    std::cout << "Allocated block id=" << next_id++ << " on "
+                              << (tier == TieredMemory::FAST ? "fast" : "slow") << " tier" << std::endl;
+            }
+            else if (cmd == "free")
+            {
+                int id;
+                if (iss >> id && tiered->deallocate(id))
+                    std::cout << "Block " << id << " freed" << std::endl;
+                else
+                    std::cout << "Error: Unknown tiered block" << std::endl;
+            }
+            else if (cmd == "access")
+            {
+                int id;
+                size_t offset;
+                uint64_t address;
+                if (iss >> id >> offset && (address = tiered->addressOf(id, offset)) != 0)
+                {
+                    int tier = tiered->tierOf(id);
+                    uint64_t epochs = tiered->getEpochs();
+                    uint64_t served[2] = {tiered->getMemoryAccesses(TieredMemory::FAST),
+                                          tiered->getMemoryAccesses(TieredMemory::SLOW)};
+                    StatsSnapshot before = Stats::capture(0);
+                    {
+                        TierScope scope(*tiered);
+                        simulateCacheAccess(caches, address);
+                    }
+                    StatsSnapshot after = Stats::capture(0);
+
+                    std::cout << "Block " << id << " offset " << offset << " served by ";
+                    if (after.levels[0].hits > before.levels[0].hits)
+                        std::cout << "L1";
+                    else if (after.levels[1].hits > before.levels[1].hits)
+                        std::cout << "L2";
+                    else if (tiered->getMemoryAccesses(TieredMemory::FAST) > served[TieredMemory::FAST])
+                        std::cout << "fast tier";
+                    else if (tiered->getMemoryAccesses(TieredMemory::SLOW) > served[TieredMemory::SLOW])
+                        std::cout << "slow tier";
+                    else
+                        std::cout << "memory";
+                    if (tiered->getEpochs() > epochs)
+                    {
+                        int now = tiered->tierOf(id);
+                        std::cout << "; migration pass ran";
+                        if (now != tier)
+                            std::cout << ", block " << (now == TieredMemory::FAST ? "promoted to fast" : "demoted to slow") << " tier";
+                    }
+                    std::cout << std::endl;
+                }
+                else
+                    std::cout << "Error: Unknown tiered block" << std::endl;
+            }
+            else if (cmd == "bench")
+            {
+                size_t objects, size;
+                uint64_t accesses;
+                if (!(iss >> objects >> size >> accesses) || objects == 0 || size == 0)
+                {
+                    std::cout << "Error: Usage tier bench <objects> <size> <accesses> [model] [seed]" << std::endl;
+                    continue;
+                }
+                // Zipf over cache lines of the object array by default
+                std::vector<std::string> flags;
+                std::string error;
+                TraceGenConfig trace_cfg = readTraceOptions(iss, objects * size, 64, flags, error, TraceModel::Zipf);
+                if (error.empty() && !flags.empty())
+                    error = "Unknown trace model " + flags[0];
+                if (!error.empty())
+                {
+                    std::cout << "Error: " << error << std::endl;
+                    continue;
+                }
+
+                std::vector<int> ids;
+                for (size_t i = 0; i < objects && tiered->allocate(size, next_id) >= 0; i++)
+                    ids.push_back(next_id++);
+                if (ids.size() < objects)
+                    std::cout << "Tiers full after " << ids.size() << " objects" << std::endl;
+                if (ids.empty())
+                    continue;
+                trace_cfg.footprint = ids.size() * size;
+                TraceGenerator gen(trace_cfg);
+
+                std::vector<uint64_t> batch(4096);
+                TierScope scope(*tiered);
+                auto start = std::chrono::steady_clock::now();
+                for (uint64_t done = 0; done < accesses; done += batch.size())
+                {
+                    size_t n = static_cast<size_t>(std::min<uint64_t>(batch.size(), accesses - done));
+                    gen.generate(batch.data(), n);
+                    for (size_t i = 0; i < n; i++)
+                        simulateCacheAccess(caches, tiered->addressOf(ids[batch[i] / size], batch[i] % size));
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cout << "Tier bench: " << accesses << " " << traceModelName(gen.getConfig().model)
+                          << " accesses over " << ids.size() << " objects in " << seconds << " s" << std::endl;
+            }
+            else if (cmd == "migrate")
+                tiered->migrate();
+            else if (cmd == "stats")
+                tiered->report();
+            else
+                std::cout << "Error: Unknown tier command" << std::endl;
+        }
+        else if (cmd == "coherence" && iss >> cmd)
+        {
+            if (cmd == "init")
+            {
+                int cores, l1_assoc, l2_assoc;
+                size_t l1_size, block_size, l2_size;
+                std::string policy, protocol = "mesi";
+                ReplacementPolicy kind;
+                if (iss >> cores >> l1_size >> block_size >> l1_assoc >> l2_size >> l2_assoc >> policy
+                    && cores > 0 && block_size > 0)
+                {
+                    if (!Cache::validGeometry(l1_size, block_size, l1_assoc) || !Cache::validGeometry(l2_size, block_size, l2_assoc))
+                    {
+                        std::cout << "Error: Caches must hold at least one set (size >= block_size * assoc)" << std::endl;
+                        continue;
+                    }
+                    if (!parsePolicy(policy, kind))
+                    {
+                        std::cout << "Error: Unknown replacement policy " << policy << std::endl;
+                        continue;
+                    }
+                    iss >> protocol;
+                    coherent = std::make_unique<CoherentSystem>(
+                        cores, l1_size, l2_size, block_size, l1_assoc, l2_assoc, policy,
+                        protocol == "moesi" ? CoherenceProtocol::MOESI : CoherenceProtocol::MESI);
+                    std::cout << "Coherent system initialized with " << cores << " cores ("
+                              << (protocol == "moesi" ? "MOESI" : "MESI") << ")" << std::endl;
+                }
+                else
+                    std::cout << "Error: Invalid coherence parameters" << std::endl;
+            }
+            else if (!coherent)
+                std::cout << "Error: Initialize coherent system first" << std::endl;
+            else if (cmd == "test")
+            {
+                size_t ops;
+                std::string pattern;
+                std::vector<std::vector<CoreOp>> streams;
+                if (!(iss >> ops >> pattern))
+                    std::cout << "Error: Usage coherence test <ops_per_core> <pattern>" << std::endl;
+                else if ((streams = generateCoreStreams(coherent->getCores(), ops, pattern,
+                                                        coherent->getBlockSize())).empty())
+                    std::cout << "Error: Unknown pattern " << pattern << std::endl;
+                else
+                {
+                    coherent->run(streams);
+                    std::cout << "Coherence test completed." << std::endl;
+                }
+            }
+            else if (cmd == "run")
+            {
+                std::vector<std::string> paths;
+                std::string path;
+                while (iss >> path)
+                    paths.push_back(path);
+
+                std::vector<std::vector<CoreOp>> streams;
+                if (paths.empty() || static_cast<int>(paths.size()) > coherent->getCores())
+                    std::cout << "Error: Give one trace file per core" << std::endl;
+                else if (!loadCoreStreams(paths, streams))
+                    std::cout << "Error: Could not read core traces" << std::endl;
+                else
+                {
+                    coherent->run(streams);
+                    std::cout << "Coherence run completed." << std::endl;
+                }
+            }
+            else if (cmd == "stats")
+                coherent->report();
+            else
+                std::cout << "Error: Unknown coherence command" << std::endl;
+        }
         else
             std::cout << "Error: Unknown command" << std::endl;
     };
 
     std::cout << "Exiting simulator." << std::endl;
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -1,6 +1,12 @@
 #include "memory.hpp"
+#include "instrument.hpp"
+#include "snapshot.hpp"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <unordered_set>
 using namespace std;
 
 Memory::Memory(size_t size)
@@ -22,23 +28,29 @@ Memory::~Memory()
 
 Block *Memory::allocate(size_t size, int id)
 {
+    INSTR_TIME(Probe::Allocate);
     const size_t MIN_SPLIT_THRESHOLD = 32;
     alloc_requests++;
 
     Block *curr = head;
+    size_t scanned = 0;
+    size_t offset = 0;
     while (curr)
     {
+        scanned++;
         if (curr->free && curr->size >= size)
         {
+            INSTR_SCANNED(scanned);
             if (curr->size >= size + MIN_SPLIT_THRESHOLD)
             {
+                INSTR_SPLIT();
                 Block *new_block = new Block{
                     curr->size - size,
                     0,
                     true,
                     -1,
-                    curr->next};
-                curr->next = new_block;
+                    nullptr};
+                linkAfter(curr, new_block);
                 curr->size = size;
             }
 
@@ -46,30 +58,38 @@ Block *Memory::allocate(size_t size, int id)
             curr->id = id;
             curr->requested_size = size;
             alloc_success++;
+            markOccupancy(offset, curr->size, true);
 
             return curr;
         }
+        offset += curr->size;
         curr = curr->next;
     }
+    INSTR_SCANNED(scanned);
     alloc_failure++;
+    recordFailure(size);
     return nullptr;
 }
 
 Block *Memory::allocateWithSelect(size_t size,int id,std::function<Block *(Block *, Block *)> select)
 {
+    INSTR_TIME(Probe::AllocateWithSelect);
     alloc_requests++;
 
-    Block *block = findFreeBlock(size, select);
+    size_t offset = 0;
+    Block *block = findFreeBlock(size, select, offset);
     if (!block)
     {
         alloc_failure++;
+        recordFailure(size);
         return nullptr;
     }
 
     if (block->size > size)
     {
-        Block *new_block = new Block{ block->size - size,0,true,-1,block->next};
-        block->next = new_block;
+        INSTR_SPLIT();
+        Block *new_block = new Block{ block->size - size,0,true,-1,nullptr};
+        linkAfter(block, new_block);
         block->size = size;
     }
 
@@ -78,33 +98,185 @@ Block *Memory::allocateWithSelect(size_t size,int id,std::function<Block *(Block
     block->requested_size = size;
 
     alloc_success++;
+    markOccupancy(offset, block->size, true);
 
     return block;
 }
 
-Block *Memory::findFreeBlock(size_t size,std::function<Block *(Block *, Block *)> select)
+Block *Memory::findFreeBlock(size_t size,std::function<Block *(Block *, Block *)> select, size_t &offset)
 {
 
     Block *candidate = nullptr;
     Block *curr = head;
+    size_t scanned = 0;
+    size_t addr = 0;
 
     while (curr)
     {
+        scanned++;
         if (curr->free && curr->size >= size)
         {
-            if (!candidate)
-                candidate = curr;
-            else
-                candidate = select(curr, candidate);
+            Block *chosen = candidate ? select(curr, candidate) : curr;
+            if (chosen == curr)
+                offset = addr;
+            candidate = chosen;
         }
+        addr += curr->size;
         curr = curr->next;
     }
+    INSTR_SCANNED(scanned);
     return candidate;
 }
 
+void Memory::splitTail(Block *block, size_t size)
+{
+    const size_t MIN_SPLIT_THRESHOLD = 32;
+    if (block->size < size + MIN_SPLIT_THRESHOLD)
+        return;
+
+    INSTR_SPLIT();
+    Block *rest = block->next;
+    if (rest && rest->free)
+    {
+        // Hand the tail straight to the free successor
+        rest->size += block->size - size;
+    }
+    else
+    {
+        linkAfter(block, new Block{block->size - size, 0, true, -1, nullptr});
+    }
+    block->size = size;
+}
+
+size_t Memory::offsetOf(const Block *block) const
+{
+    size_t offset = 0;
+    for (Block *curr = head; curr && curr != block; curr = curr->next)
+        offset += curr->size;
+    return offset;
+}
+
+Block *Memory::reallocate(int id, size_t new_size, std::function<Block *(Block *, Block *)> select)
+{
+    Block *block = head;
+    size_t offset = 0;
+    while (block && (block->free || block->id != id))
+    {
+        offset += block->size;
+        block = block->next;
+    }
+    if (!block || new_size == 0)
+        return nullptr;
+
+    size_t old_size = block->size;
+
+    // Shrink in place, returning the tail to the free list
+    if (new_size <= old_size)
+    {
+        splitTail(block, new_size);
+        markOccupancy(offset + block->size, old_size - block->size, false);
+        block->requested_size = new_size;
+        realloc_in_place++;
+        return block;
+    }
+
+    // Grow in place by taking bytes from a free successor
+    Block *next = block->next;
+    size_t need = new_size - old_size;
+    if (next && next->free && next->size >= need)
+    {
+        block->size += next->size;
+        unlinkNext(block);
+        splitTail(block, new_size);
+        markOccupancy(offset + old_size, block->size - old_size, true);
+        block->requested_size = new_size;
+        realloc_in_place++;
+        return block;
+    }
+
+    // Fall back to allocate + copy + free. The old block stays live while
+    // the new one is found, exactly like a C realloc.
+    Block *moved = select ? allocateWithSelect(new_size, id, select) : allocate(new_size, id);
+    if (!moved)
+        return nullptr;
+
+    size_t copy = std::min(block->requested_size, new_size);
+    std::memmove(data + offsetOf(moved), data + offsetOf(block), copy);
+    realloc_bytes_copied += copy;
+    realloc_moved++;
+
+    block->free = true;
+    block->id = -1;
+    block->requested_size = 0;
+    markOccupancy(offsetOf(block), block->size, false);
+    coalesce();
+    return moved;
+}
+
+Block *Memory::allocateAligned(size_t size, size_t align, int id,
+                               std::function<Block *(Block *, Block *)> select)
+{
+    INSTR_TIME(Probe::Allocate);
+    if (align == 0 || (align & (align - 1)) != 0)
+        return nullptr;
+    alloc_requests++;
+
+    Block *chosen = nullptr;
+    size_t chosen_offset = 0;
+    size_t offset = 0;
+    size_t scanned = 0;
+    for (Block *curr = head; curr; curr = curr->next)
+    {
+        scanned++;
+        size_t pad = ((offset + align - 1) & ~(align - 1)) - offset;
+        if (curr->free && curr->size >= pad + size)
+        {
+            Block *pick = chosen && select ? select(chosen, curr) : curr;
+            if (pick != chosen)
+            {
+                chosen = pick;
+                chosen_offset = offset;
+            }
+            if (!select)
+                break;
+        }
+        offset += curr->size;
+    }
+    INSTR_SCANNED(scanned);
+
+    if (!chosen)
+    {
+        alloc_failure++;
+        recordFailure(size);
+        return nullptr;
+    }
+
+    size_t pad = ((chosen_offset + align - 1) & ~(align - 1)) - chosen_offset;
+    if (pad > 0)
+    {
+        // Leading padding stays behind as its own free block
+        INSTR_SPLIT();
+        Block *aligned = new Block{chosen->size - pad, 0, true, -1, nullptr};
+        chosen->size = pad;
+        linkAfter(chosen, aligned);
+        chosen = aligned;
+        chosen_offset += pad;
+    }
+    splitTail(chosen, size);
+
+    chosen->free = false;
+    chosen->id = id;
+    chosen->requested_size = size;
+    alloc_success++;
+    markOccupancy(chosen_offset, chosen->size, true);
+    return chosen;
+}
+
 void Memory::deallocate(int id)
 {
+    INSTR_TIME(Probe::Deallocate);
     Block *curr = head;
+    size_t offset = 0;
     while (curr)
     {
         if (!curr->free && curr->id == id)
@@ -112,24 +284,91 @@ void Memory::deallocate(int id)
             curr->free = true;
             curr->id = -1;
             curr->requested_size = 0;
+            markOccupancy(offset, curr->size, false);
             coalesce();
             return;
         }
+        offset += curr->size;
         curr = curr->next;
     }
 }
 
+bool Memory::isAllocated(int id) const
+{
+    for (const Block *curr = head; curr; curr = curr->next)
+        if (!curr->free && curr->id == id)
+            return true;
+    return false;
+}
+
+void Memory::deallocateBlocks(const std::vector<Block *> &blocks)
+{
+    // The heatmap needs block offsets; find them all in one list pass
+    // rather than an offsetOf() walk per block
+    if (!occupancy.empty())
+    {
+        std::unordered_set<const Block *> releasing(blocks.begin(), blocks.end());
+        size_t offset = 0;
+        for (const Block *curr = head; curr; curr = curr->next)
+        {
+            if (releasing.count(curr))
+                markOccupancy(offset, curr->size, false);
+            offset += curr->size;
+        }
+    }
+
+    for (Block *block : blocks)
+    {
+        block->free = true;
+        block->id = -1;
+        block->requested_size = 0;
+
+        // The list never holds two adjacent free blocks, so merging with the
+        // immediate neighbours restores that invariant
+        if (block->next && block->next->free)
+        {
+            INSTR_MERGE();
+            block->size += block->next->size;
+            unlinkNext(block);
+        }
+        if (block->prev && block->prev->free)
+        {
+            INSTR_MERGE();
+            block->prev->size += block->size;
+            unlinkNext(block->prev);
+        }
+    }
+}
+
+void Memory::linkAfter(Block *block, Block *node)
+{
+    node->prev = block;
+    node->next = block->next;
+    if (node->next)
+        node->next->prev = node;
+    block->next = node;
+}
+
+void Memory::unlinkNext(Block *block)
+{
+    Block *tmp = block->next;
+    block->next = tmp->next;
+    if (block->next)
+        block->next->prev = block;
+    delete tmp;
+}
+
 void Memory::coalesce()
 {
+    INSTR_TIME(Probe::Coalesce);
     Block *curr = head;
     while (curr && curr->next)
     {
         if (curr->free && curr->next->free)
         {
+            INSTR_MERGE();
             curr->size += curr->next->size;
-            Block *tmp = curr->next;
-            curr->next = tmp->next;
-            delete tmp;
+            unlinkNext(curr);
         }
         else
         {
@@ -138,6 +377,70 @@ void Memory::coalesce()
     }
 }
 
+AllocFailure Memory::diagnoseFailure(size_t size) const
+{
+    AllocFailure f{};
+    f.request_index = alloc_requests;
+    f.requested = size;
+
+    for (Block *curr = head; curr; curr = curr->next)
+    {
+        if (!curr->free)
+            continue;
+        f.free_bytes += curr->size;
+        f.largest_free = std::max(f.largest_free, curr->size);
+        f.free_blocks++;
+
+        int bucket = 0;
+        for (size_t s = curr->size; s > 1 && bucket < AllocFailure::HIST_BUCKETS - 1; s >>= 1)
+            bucket++;
+        f.histogram[bucket]++;
+    }
+    return f;
+}
+
+void Memory::recordFailure(size_t size)
+{
+    // Failures already walked the whole list, so one more pass keeps the
+    // failure path within a constant factor of its own cost.
+    if (failures.size() == MAX_FAILURES)
+        failures.pop_front();
+    failures.push_back(diagnoseFailure(size));
+}
+
+void Memory::enableHeatmap(size_t buckets)
+{
+    if (buckets == 0)
+        buckets = 1;
+    bucket_width = (total_size + buckets - 1) / buckets;
+    occupancy.assign(buckets, 0);
+
+    size_t offset = 0;
+    for (Block *curr = head; curr; curr = curr->next)
+    {
+        if (!curr->free)
+            markOccupancy(offset, curr->size, true);
+        offset += curr->size;
+    }
+}
+
+void Memory::markOccupancy(size_t offset, size_t size, bool used)
+{
+    if (occupancy.empty() || size == 0)
+        return;
+
+    size_t end = offset + size;
+    for (size_t b = offset / bucket_width; b < occupancy.size() && b * bucket_width < end; b++)
+    {
+        size_t lo = std::max(offset, b * bucket_width);
+        size_t hi = std::min(end, (b + 1) * bucket_width);
+        if (used)
+            occupancy[b] += hi - lo;
+        else
+            occupancy[b] -= hi - lo;
+    }
+}
+
 void Memory::dump() const
 {
     Block *curr = head;
@@ -241,3 +544,92 @@ void Memory::stats() const {
     cout << "Memory utilization: "
          << utilization << "%\n";
 }
+
+
+namespace
+{
+struct SnapshotBlock
+{
+    uint64_t size;
+    uint64_t requested_size;
+    int32_t id;
+    uint32_t free;
+};
+}
+
+void Memory::save(SnapshotWriter &w) const
+{
+    w.put<uint64_t>(total_size);
+    w.put<uint64_t>(alloc_requests);
+    w.put<uint64_t>(alloc_success);
+    w.put<uint64_t>(alloc_failure);
+    w.put<uint64_t>(realloc_in_place);
+    w.put<uint64_t>(realloc_moved);
+    w.put<uint64_t>(realloc_bytes_copied);
+
+    uint64_t count = 0;
+    for (Block *curr = head; curr; curr = curr->next)
+        count++;
+    w.put<uint64_t>(count);
+
+    for (Block *curr = head; curr; curr = curr->next)
+    {
+        SnapshotBlock rec{curr->size, curr->requested_size, curr->id, curr->free ? 1u : 0u};
+        w.put(rec);
+    }
+}
+
+std::unique_ptr<Memory> Memory::restore(SnapshotReader &r)
+{
+    uint64_t total, requests, success, failure, in_place, moved, copied, count;
+    if (!r.get(total) || !r.get(requests) || !r.get(success) || !r.get(failure) ||
+        !r.get(in_place) || !r.get(moved) || !r.get(copied) || !r.get(count) || total == 0)
+        return nullptr;
+
+    // Counts come from the file: bound them before multiplying, and check the
+    // blocks tile the heap before allocating `total` bytes for it
+    if (count == 0 || count > r.remaining() / sizeof(SnapshotBlock))
+        return nullptr;
+    const uint8_t *records = r.take(count * sizeof(SnapshotBlock));
+    uint64_t covered = 0;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        SnapshotBlock rec;
+        std::memcpy(&rec, records + i * sizeof(SnapshotBlock), sizeof(rec));
+        if (rec.size == 0 || rec.size > total - covered)
+            return nullptr;
+        covered += rec.size;
+    }
+    if (covered != total)
+        return nullptr;
+
+    std::unique_ptr<Memory> mem;
+    try
+    {
+        mem = std::make_unique<Memory>(total);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return nullptr;     // Heap size the host cannot back
+    }
+    mem->alloc_requests = requests;
+    mem->alloc_success = success;
+    mem->alloc_failure = failure;
+    mem->realloc_in_place = in_place;
+    mem->realloc_moved = moved;
+    mem->realloc_bytes_copied = copied;
+
+    // Rebuild the list back to front so each node is linked as it is created
+    delete mem->head;
+    mem->head = nullptr;
+    for (uint64_t i = count; i-- > 0;)
+    {
+        SnapshotBlock rec;
+        std::memcpy(&rec, records + i * sizeof(SnapshotBlock), sizeof(rec));
+        Block *block = new Block{rec.size, rec.requested_size, rec.free != 0, rec.id, mem->head};
+        if (mem->head)
+            mem->head->prev = block;
+        mem->head = block;
+    }
+    return mem;
+}
\ No newline at end of file
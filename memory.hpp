@@ -4,7 +4,12 @@
 #include <vector>
 #include <cstdint>
 #include <list>
+#include <deque>
 #include <functional>
+#include <memory>
+
+class SnapshotWriter;
+class SnapshotReader;
 
 struct Block {
     size_t size;
@@ -12,6 +17,22 @@ struct Block {
     bool free;
     int id;
     Block* next;
+    Block* prev = nullptr;      // Maintained by Memory for its own list only
+};
+
+// Snapshot of the free list taken when an allocation fails, so callers can
+// tell true exhaustion from fragmentation.
+struct AllocFailure {
+    static const int HIST_BUCKETS = 32;   // Free blocks by floor(log2(size))
+
+    size_t request_index;   // Allocation request number (1-based)
+    size_t requested;
+    size_t free_bytes;
+    size_t largest_free;
+    size_t free_blocks;
+    uint32_t histogram[HIST_BUCKETS];
+
+    bool isFragmentation() const { return free_bytes >= requested; }
 };
 
 class Memory {
@@ -23,7 +44,25 @@ public:
     Block* allocateWithSelect(size_t size, int id,
         std::function<Block*(Block*, Block*)> select);
 
+    // Resizes block `id`, in place when possible (shrink, or grow into a free
+    // successor); otherwise allocates a new block with `select` (first fit
+    // when empty), copies the payload and frees the old one. Returns nullptr
+    // and leaves the block untouched if there is no room.
+    Block* reallocate(int id, size_t new_size,
+        std::function<Block*(Block*, Block*)> select = nullptr);
+    // Allocation whose start offset is a multiple of `align` (a power of
+    // two), placed with `select` among the blocks that fit once padded (first
+    // fit when empty). Leading padding is split off as a free block.
+    Block* allocateAligned(size_t size, size_t align, int id,
+        std::function<Block*(Block*, Block*)> select = nullptr);
+
     void deallocate(int id);
+    bool isAllocated(int id) const;
+    // Bulk region free: releases blocks previously returned by an allocation
+    // and still live, merging each only with its neighbours, so the cost is
+    // O(blocks.size()) rather than a walk of the whole list. With the heatmap
+    // on, one extra list pass finds the blocks' offsets.
+    void deallocateBlocks(const std::vector<Block*>& blocks);
     void dump() const;
     void stats() const;
 
@@ -34,6 +73,26 @@ public:
 
     const Block* getHead() const { return head; }
 
+    size_t getReallocInPlace() const { return realloc_in_place; }
+    size_t getReallocMoved() const { return realloc_moved; }
+    size_t getReallocBytesCopied() const { return realloc_bytes_copied; }
+
+    // Failure analysis: the most recent failures are kept (bounded)
+    AllocFailure diagnoseFailure(size_t size) const;
+    const std::deque<AllocFailure>& getFailures() const { return failures; }
+    const AllocFailure* getLastFailure() const { return failures.empty() ? nullptr : &failures.back(); }
+    size_t getFailureCount() const { return alloc_failure; }
+
+    // Downsampled heap occupancy, maintained incrementally on every
+    // allocate/free once enabled. Each entry is the used bytes in one bucket.
+    void enableHeatmap(size_t buckets);
+    const std::vector<size_t>& getOccupancy() const { return occupancy; }
+    size_t getBucketWidth() const { return bucket_width; }
+
+    // Snapshot support: block list and counters as flat fixed-size records
+    void save(SnapshotWriter& w) const;
+    static std::unique_ptr<Memory> restore(SnapshotReader& r);
+
 private:
     size_t total_size;
     uint8_t* data;
@@ -43,8 +102,24 @@ private:
     size_t alloc_success  = 0;
     size_t alloc_failure  = 0;
 
-    Block* findFreeBlock(size_t size, std::function<Block*(Block*, Block*)> select);
+    size_t realloc_in_place = 0;
+    size_t realloc_moved = 0;
+    size_t realloc_bytes_copied = 0;
+
+    static const size_t MAX_FAILURES = 256;
+    std::deque<AllocFailure> failures;
+
+    std::vector<size_t> occupancy;
+    size_t bucket_width = 0;
+
+    Block* findFreeBlock(size_t size, std::function<Block*(Block*, Block*)> select, size_t& offset);
     void coalesce();
+    void linkAfter(Block* block, Block* node);
+    void unlinkNext(Block* block);
+    void splitTail(Block* block, size_t size);
+    size_t offsetOf(const Block* block) const;
+    void recordFailure(size_t size);
+    void markOccupancy(size_t offset, size_t size, bool used);
 };
 
 #endif
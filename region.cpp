@@ -0,0 +1,184 @@
+#include "region.hpp"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+const size_t REGION_ALIGN = 8;
+
+size_t alignUp(size_t size)
+{
+    return (size + REGION_ALIGN - 1) & ~(REGION_ALIGN - 1);
+}
+}
+
+RegionManager::RegionManager(int first_chunk_id) : next_chunk(first_chunk_id) {}
+
+int RegionManager::create(size_t chunk_size)
+{
+    int id = next_region++;
+    Region r;
+    r.id = id;
+    r.chunk_size = chunk_size;
+    regions.emplace(id, r);
+    return id;
+}
+
+Region &RegionManager::oldGeneration(const Region &like)
+{
+    auto it = regions.find(OLD_GENERATION);
+    if (it == regions.end())
+    {
+        Region r;
+        r.id = OLD_GENERATION;
+        r.chunk_size = like.chunk_size;
+        it = regions.emplace(OLD_GENERATION, r).first;
+    }
+    return it->second;
+}
+
+int RegionManager::bump(Memory &mem, Allocator &alloc, Region &r, size_t size, int object_id)
+{
+    size_t aligned = alignUp(size);
+
+    // Slow path: current chunk exhausted, reserve a new one from Memory
+    if (r.chunks.empty() || r.capacity - r.bump < aligned)
+    {
+        size_t chunk = std::max(r.chunk_size, aligned);
+        Block *block = alloc.allocate(mem, chunk, next_chunk);
+        if (!block)
+            return -1;
+        r.chunks.push_back(next_chunk++);
+        r.blocks.push_back(block);
+        r.capacity = chunk;
+        r.bump = 0;
+    }
+
+    objects[object_id] = RegionObject{r.id, r.chunks.back(), r.bump, size, false};
+    r.objects.push_back(object_id);
+    r.bump += aligned;
+    r.used += aligned;
+    return object_id;
+}
+
+int RegionManager::allocate(Memory &mem, Allocator &alloc, int region, size_t size)
+{
+    auto it = regions.find(region);
+    if (it == regions.end() || size == 0)
+        return -1;
+
+    int id = bump(mem, alloc, it->second, size, next_object);
+    if (id >= 0)
+        next_object++;
+    return id;
+}
+
+bool RegionManager::markSurvivor(int object_id)
+{
+    auto it = objects.find(object_id);
+    if (it == objects.end() || it->second.region == OLD_GENERATION)
+        return false;
+    it->second.survivor = true;
+    return true;
+}
+
+bool RegionManager::release(Memory &mem, Allocator &alloc, int region)
+{
+    auto it = regions.find(region);
+    if (it == regions.end())
+        return false;
+
+    // Detach the region first so survivors are never promoted back into it
+    Region r = std::move(it->second);
+    regions.erase(it);
+
+    for (int obj : r.objects)
+    {
+        const RegionObject o = objects[obj];
+        if (region != OLD_GENERATION && o.survivor)
+        {
+            // Generational promotion: copy the survivor into the old region
+            if (bump(mem, alloc, oldGeneration(r), o.size, obj) >= 0)
+            {
+                promoted_objects++;
+                promoted_bytes += o.size;
+                continue;
+            }
+            dropped_survivors++;
+        }
+        objects.erase(obj);
+    }
+
+    mem.deallocateBlocks(r.blocks);
+    regions_freed++;
+    return true;
+}
+
+const RegionObject *RegionManager::find(int object_id) const
+{
+    auto it = objects.find(object_id);
+    return it == objects.end() ? nullptr : &it->second;
+}
+
+void RegionManager::report() const
+{
+    std::cout << "\n===== Region Statistics =====\n";
+    std::vector<int> ids;
+    for (const auto &kv : regions)
+        ids.push_back(kv.first);
+    std::sort(ids.begin(), ids.end());
+
+    for (int id : ids)
+    {
+        const Region &r = regions.at(id);
+        std::cout << "Region " << id
+                  << (id == OLD_GENERATION ? " (old generation)" : "")
+                  << ": chunks=" << r.chunks.size()
+                  << ", objects=" << r.objects.size()
+                  << ", used=" << r.used << " bytes\n";
+    }
+    std::cout << "Regions freed: " << regions_freed << "\n";
+    std::cout << "Promoted objects: " << promoted_objects
+              << " (" << promoted_bytes << " bytes)\n";
+    if (dropped_survivors)
+        std::cout << "Survivors dropped (old generation full): " << dropped_survivors << "\n";
+    std::cout << "==============================\n";
+}
+
+void RegionManager::benchmark(size_t count, size_t size)
+{
+    using clock = std::chrono::steady_clock;
+    size_t mem_size = count * (size + REGION_ALIGN) * 2 + 4096;
+    FirstFit alloc;
+
+    // Per-id path: the same trace freed one block at a time
+    Memory per_id(mem_size);
+    auto t0 = clock::now();
+    for (size_t i = 0; i < count; i++)
+        alloc.allocate(per_id, size, static_cast<int>(i + 1));
+    auto t1 = clock::now();
+    for (size_t i = 0; i < count; i++)
+        per_id.deallocate(static_cast<int>(i + 1));
+    auto t2 = clock::now();
+
+    // Region path: bump allocation, one bulk free
+    Memory arena(mem_size);
+    RegionManager rm;
+    int r = rm.create(64 * 1024);
+    auto t3 = clock::now();
+    for (size_t i = 0; i < count; i++)
+        rm.allocate(arena, alloc, r, size);
+    auto t4 = clock::now();
+    rm.release(arena, alloc, r);
+    auto t5 = clock::now();
+
+    auto us = [](clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    };
+
+    std::cout << "\n===== Region Benchmark =====\n";
+    std::cout << "Objects: " << count << " x " << size << " bytes\n";
+    std::cout << "Per-id  alloc: " << us(t1 - t0) << " us, free: " << us(t2 - t1) << " us\n";
+    std::cout << "Region  alloc: " << us(t4 - t3) << " us, free: " << us(t5 - t4) << " us\n";
+    std::cout << "==============================\n";
+}
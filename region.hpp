@@ -0,0 +1,79 @@
+#ifndef REGION_HPP
+#define REGION_HPP
+
+#include "memory.hpp"
+#include "allocator.hpp"
+#include <unordered_map>
+#include <vector>
+
+// A region (arena) reserves large chunks from Memory and hands out objects
+// by bumping an offset. Objects are never freed individually; the whole
+// region is released at once, which costs O(chunks) instead of one
+// list walk + coalesce per object.
+struct RegionObject {
+    int region;
+    int chunk;          // Memory block id of the backing chunk
+    size_t offset;      // Offset inside the chunk
+    size_t size;
+    bool survivor;      // Marked live; promoted to the old generation on free
+};
+
+struct Region {
+    int id;
+    size_t chunk_size;
+    std::vector<int> chunks;    // Memory block ids, oldest first
+    std::vector<Block*> blocks; // The same chunks' Memory blocks, for the bulk free
+    size_t bump = 0;            // Next free offset in the newest chunk
+    size_t capacity = 0;        // Size of the newest chunk
+    size_t used = 0;            // Bytes handed out (including alignment)
+    std::vector<int> objects;
+};
+
+class RegionManager {
+public:
+    // Region 0 is the old generation; survivors of freed regions land there.
+    static constexpr int OLD_GENERATION = 0;
+    // Chunk block ids start here, clear of the ids the CLI hands out. Chunks
+    // are freed through their Block pointers, so they must only be released
+    // by release(), never by id.
+    static constexpr int FIRST_CHUNK_ID = 1 << 30;
+
+    explicit RegionManager(int first_chunk_id = FIRST_CHUNK_ID);
+
+    int create(size_t chunk_size);
+    // Returns the new object id, or -1 if the region does not exist or
+    // Memory could not supply another chunk.
+    int allocate(Memory& mem, Allocator& alloc, int region, size_t size);
+    bool markSurvivor(int object_id);
+    // Releases every chunk of the region. Survivors are copied into the old
+    // generation first; any that do not fit are dropped and counted.
+    // Returns false if the region does not exist.
+    bool release(Memory& mem, Allocator& alloc, int region);
+
+    const RegionObject* find(int object_id) const;
+    void report() const;
+
+    // Times per-id malloc/free against region bump + bulk free on the same trace
+    static void benchmark(size_t count, size_t size);
+
+    size_t getPromotedObjects() const { return promoted_objects; }
+    size_t getPromotedBytes() const { return promoted_bytes; }
+    size_t getDroppedSurvivors() const { return dropped_survivors; }
+
+private:
+    std::unordered_map<int, Region> regions;
+    std::unordered_map<int, RegionObject> objects;
+    int next_region = 1;
+    int next_object = 1;
+    int next_chunk;
+
+    size_t promoted_objects = 0;
+    size_t promoted_bytes = 0;
+    size_t dropped_survivors = 0;   // Survivors lost because the old generation was full
+    size_t regions_freed = 0;
+
+    int bump(Memory& mem, Allocator& alloc, Region& r, size_t size, int object_id);
+    Region& oldGeneration(const Region& like);
+};
+
+#endif
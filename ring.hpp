@@ -0,0 +1,52 @@
+#ifndef RING_HPP
+#define RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bounded single-producer / single-consumer queue. Each index is written by
+// one side only, so push and pop take no lock; a thread facing a full or
+// empty ring yields. Items are moved through, so a batch travels as one
+// pointer-sized handoff.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : slots(capacity + 1) {}
+
+    // Blocks while the ring is full
+    void push(T&& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = t + 1 == slots.size() ? 0 : t + 1;
+        while (next == head.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        slots[t] = std::move(item);
+        tail.store(next, std::memory_order_release);
+    }
+
+    // Blocks while the ring is empty; false once it is closed and drained
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        while (h == tail.load(std::memory_order_acquire)) {
+            if (closed.load(std::memory_order_acquire) && h == tail.load(std::memory_order_acquire))
+                return false;
+            std::this_thread::yield();
+        }
+        item = std::move(slots[h]);
+        head.store(h + 1 == slots.size() ? 0 : h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: nothing more will be pushed
+    void close() { closed.store(true, std::memory_order_release); }
+
+private:
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head{0};    // Next slot to pop (consumer)
+    alignas(64) std::atomic<size_t> tail{0};    // Next slot to push (producer)
+    std::atomic<bool> closed{false};
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "sampling.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+const size_t CHUNK = 1 << 16;   // Addresses read/warmed per batch
+
+bool parseAddressLine(const std::string& line, uint64_t& address) {
+    const char* p = line.c_str();
+    while (*p == ' ' || *p == '\t')
+        p++;
+    if ((*p == 'r' || *p == 'w') && (p[1] == ' ' || p[1] == '\t'))
+        p += 2;
+    char* end;
+    address = std::strtoull(p, &end, 16);
+    return end != p;
+}
+
+// Mirrors simulateCacheAccess(): L1, then L2 with refill into L1 on a hit.
+// Hierarchy-level outcomes go to counters[level].
+void detailedAccess(std::vector<std::unique_ptr<Cache>>& caches, uint64_t address,
+                    LevelCounters* counters) {
+    bool hit;
+    caches[0]->access(address, hit);
+    (hit ? counters[0].hits : counters[0].misses)++;
+    if (hit)
+        return;
+    if (caches.size() >= 2 && caches[1]) {
+        caches[1]->access(address, hit);
+        (hit ? counters[1].hits : counters[1].misses)++;
+        if (hit)
+            caches[0]->access(address, hit);
+    }
+}
+
+// Functional warming of n addresses from source, in CHUNK-sized batches
+void warmFrom(std::vector<std::unique_ptr<Cache>>& caches, AddressSource& source,
+              uint64_t n, std::vector<uint64_t>& chunk) {
+    Cache* l2 = caches.size() >= 2 ? caches[1].get() : nullptr;
+    while (n > 0) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(n, chunk.size()));
+        source.generate(chunk.data(), len);
+        Cache::warmBatch(*caches[0], l2, chunk.data(), len);
+        n -= len;
+    }
+}
+
+size_t levelCount(const std::vector<std::unique_ptr<Cache>>& caches) {
+    return (caches.size() >= 2 && caches[1]) ? 2 : 1;
+}
+
+// Ratio estimator over samples: hit rate = sum(hits) / sum(accesses). A
+// sample's weight is its access count, which differs per sample at L2, so
+// averaging per-sample rates would overweight samples with few L2 lookups.
+// The variance uses the residuals hits_i - R * accesses_i.
+struct RatioEstimator {
+    size_t k = 0;
+    double h = 0.0, n = 0.0, hh = 0.0, nn = 0.0, hn = 0.0;
+    void add(const LevelCounters& c) {
+        double hi = static_cast<double>(c.hits), ni = static_cast<double>(c.total());
+        k++;
+        h += hi;
+        n += ni;
+        hh += hi * hi;
+        nn += ni * ni;
+        hn += hi * ni;
+    }
+    double ratio() const { return n > 0 ? h / n : 0.0; }
+    double ci95() const {
+        if (k < 2 || n <= 0)
+            return 0.0;
+        double r = ratio(), mean_n = n / k;
+        double residuals = std::max(0.0, hh - 2 * r * hn + r * r * nn);
+        return 1.96 * std::sqrt(residuals / ((k - 1) * k * mean_n * mean_n));
+    }
+};
+}
+
+bool AddressFileSource::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    char magic[sizeof(ADDRESS_TRACE_MAGIC)] = {};
+    in.read(magic, sizeof(magic));
+    binary = in && std::memcmp(magic, ADDRESS_TRACE_MAGIC, sizeof(magic)) == 0;
+    if (binary) {
+        in.seekg(0, std::ios::end);
+        count = (static_cast<uint64_t>(in.tellg()) - sizeof(magic)) / sizeof(uint64_t);
+        in.seekg(sizeof(magic));
+        return true;
+    }
+
+    // Text: one counting pass so the sampler knows the stream length
+    in.clear();
+    in.seekg(0);
+    std::string line;
+    uint64_t address;
+    while (std::getline(in, line))
+        count += parseAddressLine(line, address);
+    in.clear();
+    in.seekg(0);
+    return true;
+}
+
+bool AddressFileSource::refill() {
+    buffer.resize(CHUNK);
+    size_t n = 0;
+    if (binary) {
+        uint64_t want = std::min<uint64_t>(CHUNK, count - std::min(count, file_index));
+        in.read(reinterpret_cast<char*>(buffer.data()), want * sizeof(uint64_t));
+        n = static_cast<size_t>(in.gcount()) / sizeof(uint64_t);
+    } else {
+        std::string line;
+        while (n < CHUNK && std::getline(in, line))
+            n += parseAddressLine(line, buffer[n]);
+    }
+    buffer.resize(n);
+    buffer_pos = 0;
+    file_index += n;
+    return n > 0;
+}
+
+uint64_t AddressFileSource::next() {
+    if (buffer_pos == buffer.size() && !refill())
+        return 0;
+    return buffer[buffer_pos++];
+}
+
+void AddressFileSource::generate(uint64_t* out, size_t n) {
+    while (n > 0) {
+        if (buffer_pos == buffer.size() && !refill()) {
+            std::fill(out, out + n, 0);
+            return;
+        }
+        size_t take = std::min(n, buffer.size() - buffer_pos);
+        std::copy(buffer.begin() + buffer_pos, buffer.begin() + buffer_pos + take, out);
+        buffer_pos += take;
+        out += take;
+        n -= take;
+    }
+}
+
+void AddressFileSource::skip(uint64_t n) {
+    uint64_t buffered = std::min<uint64_t>(n, buffer.size() - buffer_pos);
+    buffer_pos += buffered;
+    n -= buffered;
+    if (n == 0)
+        return;
+    if (!binary) {
+        AddressSource::skip(n);
+        return;
+    }
+    file_index = std::min(count, file_index + n);
+    buffer.clear();
+    buffer_pos = 0;
+    in.clear();
+    in.seekg(sizeof(ADDRESS_TRACE_MAGIC) + file_index * sizeof(uint64_t));
+}
+
+bool writeAddressTrace(const std::string& path, AddressSource& source, uint64_t n) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+    out.write(ADDRESS_TRACE_MAGIC, sizeof(ADDRESS_TRACE_MAGIC));
+    std::vector<uint64_t> chunk(CHUNK);
+    while (n > 0 && out) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(n, chunk.size()));
+        source.generate(chunk.data(), len);
+        out.write(reinterpret_cast<const char*>(chunk.data()), len * sizeof(uint64_t));
+        n -= len;
+    }
+    return static_cast<bool>(out);
+}
+
+SamplingResult runSampled(std::vector<std::unique_ptr<Cache>>& caches,
+                          AddressSource& source, const SamplingConfig& cfg) {
+    SamplingResult res;
+    size_t levels = levelCount(caches);
+    std::vector<RatioEstimator> stats(levels);
+    std::vector<uint64_t> chunk(CHUNK);
+
+    uint64_t sample = std::min(cfg.sample, cfg.period);
+    uint64_t warmup = std::min(cfg.warmup, cfg.period - sample);
+    uint64_t fast_forward = cfg.period - sample;
+    uint64_t skip = warmup == 0 ? 0 : fast_forward - warmup;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t done = 0; done + cfg.period <= cfg.accesses; done += cfg.period) {
+        source.skip(skip);
+        warmFrom(caches, source, fast_forward - skip, chunk);
+        res.skipped += skip;
+        res.warmed += fast_forward - skip;
+
+        LevelCounters counters[2];
+        for (uint64_t i = 0; i < sample; i++)
+            detailedAccess(caches, source.next(), counters);
+        res.detailed += sample;
+
+        for (size_t l = 0; l < levels; l++) {
+            Stats::level(l).hits += counters[l].hits;
+            Stats::level(l).misses += counters[l].misses;
+            stats[l].add(counters[l]);
+        }
+        res.samples++;
+    }
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const RatioEstimator& e : stats)
+        res.levels.push_back({100.0 * e.ratio(), 100.0 * e.ci95()});
+    return res;
+}
+
+SamplingResult runFull(std::vector<std::unique_ptr<Cache>>& caches,
+                       AddressSource& source, uint64_t accesses) {
+    SamplingResult res;
+    size_t levels = levelCount(caches);
+    LevelCounters counters[2];
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < accesses; i++)
+        detailedAccess(caches, source.next(), counters);
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    res.detailed = accesses;
+    res.samples = 1;
+
+    for (size_t l = 0; l < levels; l++)
+        res.levels.push_back({counters[l].hitRate(), 0.0});
+    return res;
+}
+
+void printSampling(const SamplingResult& res, const char* label) {
+    std::cout << "\n===== " << label << " =====\n";
+    std::cout << "Samples: " << res.samples
+              << " (detailed " << res.detailed
+              << ", warmed " << res.warmed
+              << ", skipped " << res.skipped << ")\n";
+    for (size_t l = 0; l < res.levels.size(); l++) {
+        std::cout << "L" << l + 1 << " hit rate: " << res.levels[l].hit_rate << "%";
+        if (res.samples > 1)
+            std::cout << " +/- " << res.levels[l].ci95 << "% (95% CI)";
+        std::cout << "\n";
+    }
+    std::cout << "Time: " << res.seconds << " s\n";
+    std::cout << "==============================\n";
+}
+
+void printSamplingSpeedup(const SamplingResult& sampled, const SamplingResult& full) {
+    std::cout << "Speedup: " << (sampled.seconds > 0 ? full.seconds / sampled.seconds : 0.0) << "x";
+    uint64_t total = sampled.detailed + sampled.warmed + sampled.skipped;
+    if (sampled.skipped > 0 && total > 0)
+        std::cout << " (" << 100.0 * sampled.skipped / total
+                  << "% of accesses skipped unwarmed; warm the whole fast-forward"
+                  << " with warmup 0 for exact cache state)";
+    std::cout << "\n";
+    for (size_t l = 0; l < full.levels.size() && l < sampled.levels.size(); l++)
+        std::cout << "L" << l + 1 << " error: "
+                  << std::abs(full.levels[l].hit_rate - sampled.levels[l].hit_rate) << "%\n";
+}
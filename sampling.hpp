@@ -0,0 +1,93 @@
+#ifndef SAMPLING_HPP
+#define SAMPLING_HPP
+
+#include "cache.hpp"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A stream of addresses that can be fast-forwarded. skip() may avoid
+// producing the skipped addresses when they do not affect later ones.
+class AddressSource {
+public:
+    virtual uint64_t next() = 0;
+    virtual void generate(uint64_t* out, size_t n) { for (size_t i = 0; i < n; i++) out[i] = next(); }
+    virtual void skip(uint64_t n) { while (n--) next(); }
+    virtual ~AddressSource() {}
+};
+
+// Address trace on disk, so recorded workloads can be sampled. Either binary
+// (ADDRESS_TRACE_MAGIC, then little-endian uint64 addresses; skip() seeks)
+// or text with one "<hex>" or "r|w <hex>" line per access, the coherence
+// per-core format. Text lines that do not parse are ignored.
+static const char ADDRESS_TRACE_MAGIC[8] = {'M', 'M', 'A', 'D', 'D', 'R', 'S', '1'};
+
+class AddressFileSource : public AddressSource {
+public:
+    bool open(const std::string& path);
+    uint64_t size() const { return count; }     // Addresses in the file
+
+    uint64_t next() override;
+    void generate(uint64_t* out, size_t n) override;
+    void skip(uint64_t n) override;
+
+private:
+    std::ifstream in;
+    bool binary = false;
+    uint64_t count = 0;
+    uint64_t file_index = 0;        // Addresses read from the file so far
+    std::vector<uint64_t> buffer;
+    size_t buffer_pos = 0;
+
+    bool refill();
+};
+
+// Writes n addresses of source in the binary format
+bool writeAddressTrace(const std::string& path, AddressSource& source, uint64_t n);
+
+// SMARTS-style systematic sampling: every `period` accesses, `sample`
+// accesses are simulated in detail. With warmup == 0 the rest of the period
+// is functionally warmed, so cache state is exact at every sample and the
+// only error is sampling error. Warming costs nearly as much as a detailed
+// access, so this mode is only ~1.2-1.3x faster than runFull(). With
+// warmup > 0 just `warmup` accesses are warmed and the rest are skipped
+// unwarmed: much faster, but state going into a sample is stale and the
+// estimate can be biased.
+struct SamplingConfig {
+    uint64_t accesses;
+    uint64_t period;
+    uint64_t sample;
+    uint64_t warmup;
+};
+
+struct LevelEstimate {
+    double hit_rate = 0.0;      // Pooled hits / accesses over all samples (%)
+    double ci95 = 0.0;          // Half-width of the 95% confidence interval
+};
+
+struct SamplingResult {
+    size_t samples = 0;
+    uint64_t detailed = 0;
+    uint64_t warmed = 0;
+    uint64_t skipped = 0;       // Never simulated in any way
+    double seconds = 0.0;
+    std::vector<LevelEstimate> levels;
+};
+
+// Detailed accesses are counted into Stats::level() like simulateCacheAccess
+SamplingResult runSampled(std::vector<std::unique_ptr<Cache>>& caches,
+                          AddressSource& source, const SamplingConfig& cfg);
+
+// Detailed simulation of every access, for measuring sampling error/speedup.
+// Used on a copy of the caches, so Stats::level() is left alone.
+SamplingResult runFull(std::vector<std::unique_ptr<Cache>>& caches,
+                       AddressSource& source, uint64_t accesses);
+
+void printSampling(const SamplingResult& res, const char* label);
+
+// Speedup of sampled over full, with how much of it came from skipping
+void printSamplingSpeedup(const SamplingResult& sampled, const SamplingResult& full);
+
+#endif
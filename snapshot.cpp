@@ -0,0 +1,171 @@
+#include "snapshot.hpp"
+#include "memory.hpp"
+#include "allocator.hpp"
+#include "cache.hpp"
+#include "stats.hpp"
+#include <cstdio>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_MMAP 1
+#endif
+
+namespace {
+const char SNAPSHOT_MAGIC[8] = {'M', 'M', 'S', 'N', 'A', 'P', '0', '1'};
+const uint32_t SNAPSHOT_VERSION = 4;
+
+// Read-only view of a snapshot file: mmap where available, else a heap copy
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef SNAPSHOT_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED) {
+                data = static_cast<const uint8_t*>(m);
+                size = st.st_size;
+            }
+        }
+        ::close(fd);
+#else
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f)
+            return;
+        std::fseek(f, 0, SEEK_END);
+        long n = std::ftell(f);
+        std::fseek(f, 0, SEEK_SET);
+        if (n > 0) {
+            copy.resize(n);
+            if (std::fread(copy.data(), 1, n, f) == (size_t)n) {
+                data = copy.data();
+                size = n;
+            }
+        }
+        std::fclose(f);
+#endif
+    }
+    ~MappedFile() {
+#ifdef SNAPSHOT_MMAP
+        if (data)
+            munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+private:
+#ifndef SNAPSHOT_MMAP
+    std::vector<uint8_t> copy;
+#endif
+};
+}
+
+bool SnapshotWriter::writeFile(const std::string& path) const {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+bool Snapshot::save(const std::string& path,
+                    const Memory& mem,
+                    const Allocator* alloc,
+                    const std::vector<std::unique_ptr<Cache>>& caches,
+                    const std::vector<int64_t>& counters) {
+    SnapshotWriter w;
+    w.putBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    w.put<uint32_t>(SNAPSHOT_VERSION);
+
+    mem.save(w);
+
+    w.put<uint8_t>(alloc != nullptr);
+    if (alloc) {
+        w.putString(alloc->name());
+        alloc->save(w);
+    }
+
+    w.put<uint32_t>(static_cast<uint32_t>(caches.size()));
+    for (const auto& c : caches) {
+        w.put<uint8_t>(c != nullptr);
+        if (c)
+            c->save(w);
+    }
+
+    w.put<uint32_t>(static_cast<uint32_t>(counters.size()));
+    for (int64_t v : counters)
+        w.put<int64_t>(v);
+
+    return w.writeFile(path);
+}
+
+bool Snapshot::load(const std::string& path,
+                    std::unique_ptr<Memory>& mem,
+                    std::unique_ptr<Allocator>& alloc,
+                    std::vector<std::unique_ptr<Cache>>& caches,
+                    std::vector<int64_t>& counters,
+                    size_t expected_counters) {
+    MappedFile file(path);
+    if (!file.data)
+        return false;
+
+    SnapshotReader r(file.data, file.size);
+    const uint8_t* magic = r.take(sizeof(SNAPSHOT_MAGIC));
+    uint32_t version;
+    if (!magic || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        !r.get(version) || version != SNAPSHOT_VERSION)
+        return false;
+
+    // Decode into temporaries so a truncated file leaves the live state intact
+    std::unique_ptr<Memory> new_mem = Memory::restore(r);
+    if (!new_mem)
+        return false;
+
+    std::unique_ptr<Allocator> new_alloc;
+    uint8_t has_alloc;
+    if (!r.get(has_alloc))
+        return false;
+    if (has_alloc) {
+        std::string name;
+        if (!r.getString(name))
+            return false;
+        new_alloc = createAllocator(name, new_mem->getTotalSize());
+        if (!new_alloc || !new_alloc->load(r))
+            return false;
+    }
+
+    uint32_t levels;
+    if (!r.get(levels) || levels > static_cast<uint32_t>(Stats::MAX_LEVELS))
+        return false;
+    std::vector<std::unique_ptr<Cache>> new_caches(levels);
+    for (uint32_t i = 0; i < levels; i++) {
+        uint8_t present;
+        if (!r.get(present))
+            return false;
+        if (present && !(new_caches[i] = Cache::restore(r)))
+            return false;
+    }
+
+    uint32_t count;
+    if (!r.get(count) || count != expected_counters)
+        return false;
+    std::vector<int64_t> new_counters(count);
+    for (uint32_t i = 0; i < count; i++)
+        if (!r.get(new_counters[i]))
+            return false;
+
+    mem = std::move(new_mem);
+    alloc = std::move(new_alloc);
+    caches = std::move(new_caches);
+    counters = std::move(new_counters);
+    return true;
+}
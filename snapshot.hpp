@@ -0,0 +1,93 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+
+class Memory;
+class Allocator;
+class Cache;
+
+// Little-endian, fixed-layout binary stream. Bulk arrays (block list, cache
+// lines) are stored as flat fixed-size records so a mapped file can be read
+// in place without per-field parsing.
+class SnapshotWriter {
+public:
+    template <typename T>
+    void put(const T& value) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+    void putBytes(const void* data, size_t n) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        buf.insert(buf.end(), p, p + n);
+    }
+    void putString(const std::string& s) {
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        putBytes(s.data(), s.size());
+    }
+    bool writeFile(const std::string& path) const;
+
+private:
+    std::vector<uint8_t> buf;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t size) : p(data), end(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end - p) < sizeof(T))
+            return false;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+    // Returns a pointer into the underlying (possibly mapped) buffer
+    const uint8_t* take(size_t n) {
+        if (static_cast<size_t>(end - p) < n)
+            return nullptr;
+        const uint8_t* r = p;
+        p += n;
+        return r;
+    }
+    size_t remaining() const { return static_cast<size_t>(end - p); }
+    bool getString(std::string& s) {
+        uint32_t n;
+        const uint8_t* d;
+        if (!get(n) || !(d = take(n)))
+            return false;
+        s.assign(reinterpret_cast<const char*>(d), n);
+        return true;
+    }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+class Snapshot {
+public:
+    // `counters` carries the CLI state that lives outside the simulator
+    // objects (next block id, per-level hit/miss counters). load() fails,
+    // leaving every argument untouched, unless the file holds exactly
+    // `expected_counters` of them.
+    static bool save(const std::string& path,
+                     const Memory& mem,
+                     const Allocator* alloc,
+                     const std::vector<std::unique_ptr<Cache>>& caches,
+                     const std::vector<int64_t>& counters);
+
+    static bool load(const std::string& path,
+                     std::unique_ptr<Memory>& mem,
+                     std::unique_ptr<Allocator>& alloc,
+                     std::vector<std::unique_ptr<Cache>>& caches,
+                     std::vector<int64_t>& counters,
+                     size_t expected_counters);
+};
+
+#endif
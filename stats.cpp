@@ -1,6 +1,9 @@
 #include "stats.hpp"
+#include "instrument.hpp"
 #include <iostream>
+#include <iomanip>
 #include <algorithm>
+#include <cmath>
 
 void Stats::report(const Memory& mem) {
     std::cout << std::dec;
@@ -38,13 +41,18 @@ void Stats::report(const Memory& mem) {
     std::cout << "Memory utilization: " << memory_utilization << "%\n";
     std::cout << "Internal fragmentation: " << internal_fragmentation << " bytes\n";
     std::cout << "External fragmentation: " << external_fragmentation << "%\n";
+    if (mem.getReallocInPlace() + mem.getReallocMoved() > 0) {
+        std::cout << "Reallocs in place: " << mem.getReallocInPlace() << "\n";
+        std::cout << "Reallocs moved: " << mem.getReallocMoved() << "\n";
+        std::cout << "Realloc bytes copied: " << mem.getReallocBytesCopied() << "\n";
+    }
     std::cout << "==============================\n";
 }
 
 void Stats::reportCache(const Cache& cache) {
-    int hits = cache.getHits();
-    int misses = cache.getMisses();
-    int total_accesses = hits + misses;
+    uint64_t hits = cache.getHits();
+    uint64_t misses = cache.getMisses();
+    uint64_t total_accesses = hits + misses;
     double hit_rate = cache.getHitRate();
     
     std::cout << "\n===== Cache Statistics =====\n";
@@ -59,4 +67,175 @@ void Stats::reportCache(const Cache& cache) {
 void Stats::reportCombined(const Memory& mem, const Cache& cache) {
     report(mem);
     reportCache(cache);
-}
\ No newline at end of file
+}
+
+void Stats::reportLatency() {
+    if (!INSTR_ENABLED) {
+        std::cout << "Instrumentation disabled (rebuild with make INSTRUMENT=1)\n";
+        return;
+    }
+    const Instrumentation& ins = Instrumentation::get();
+    std::streamsize precision = std::cout.precision();
+
+    std::cout << "\n===== Latency (" << cycleUnit() << ") =====\n";
+    std::cout << std::left << std::setw(20) << "operation"
+              << std::right << std::setw(10) << "count"
+              << std::setw(10) << "mean"
+              << std::setw(10) << "p50"
+              << std::setw(10) << "p90"
+              << std::setw(10) << "p99"
+              << std::setw(12) << "max" << "\n";
+    for (int i = 0; i < (int)Probe::Count; i++) {
+        const LatencyHistogram& h = ins.latency[i];
+        std::cout << std::left << std::setw(20) << probeName((Probe)i)
+                  << std::right << std::setw(10) << h.count()
+                  << std::setw(10) << std::fixed << std::setprecision(1) << h.mean()
+                  << std::defaultfloat
+                  << std::setw(10) << h.percentile(50)
+                  << std::setw(10) << h.percentile(90)
+                  << std::setw(10) << h.percentile(99)
+                  << std::setw(12) << h.max() << "\n";
+    }
+    std::cout.precision(precision);
+    const LatencyHistogram& scan = ins.blocks_scanned;
+    std::cout << "Blocks scanned per allocation: mean " << scan.mean()
+              << ", p99 " << scan.percentile(99) << ", max " << scan.max() << "\n";
+    std::cout << "Splits: " << ins.splits << "\n";
+    std::cout << "Merges: " << ins.merges << "\n";
+    std::cout << "==============================\n";
+}
+
+void Stats::reportJson(const Memory* mem) {
+    const Instrumentation& ins = Instrumentation::get();
+    std::ostream& out = std::cout;
+
+    out << "{";
+    if (mem) {
+        out << "\"memory\":{\"total\":" << mem->getTotalSize()
+            << ",\"used\":" << mem->getUsedSize()
+            << ",\"internal_fragmentation\":" << mem->getInternalFragmentation()
+            << ",\"external_fragmentation\":" << mem->getExternalFragmentation()
+            << ",\"realloc_in_place\":" << mem->getReallocInPlace()
+            << ",\"realloc_moved\":" << mem->getReallocMoved()
+            << ",\"realloc_bytes_copied\":" << mem->getReallocBytesCopied()
+            << "},";
+    }
+    out << "\"cache\":[";
+    for (int l = 0; l < MAX_LEVELS; l++)
+        out << (l ? "," : "") << "{\"hits\":" << levels[l].hits << ",\"misses\":" << levels[l].misses << "}";
+    out << "],";
+    out << "\"instrumentation\":{\"enabled\":" << (INSTR_ENABLED ? "true" : "false")
+        << ",\"unit\":\"" << cycleUnit() << "\",\"latency\":{";
+    for (int i = 0; i < (int)Probe::Count; i++) {
+        const LatencyHistogram& h = ins.latency[i];
+        out << (i ? "," : "") << "\"" << probeName((Probe)i) << "\":{"
+            << "\"count\":" << h.count()
+            << ",\"mean\":" << h.mean()
+            << ",\"min\":" << h.min()
+            << ",\"p50\":" << h.percentile(50)
+            << ",\"p90\":" << h.percentile(90)
+            << ",\"p99\":" << h.percentile(99)
+            << ",\"max\":" << h.max() << "}";
+    }
+    const LatencyHistogram& scan = ins.blocks_scanned;
+    out << "},\"blocks_scanned\":{\"count\":" << scan.count()
+        << ",\"mean\":" << scan.mean()
+        << ",\"p99\":" << scan.percentile(99)
+        << ",\"max\":" << scan.max() << "}"
+        << ",\"splits\":" << ins.splits
+        << ",\"merges\":" << ins.merges << "}}\n";
+}
+void Stats::resetLevels() {
+    for (LevelCounters& l : levels)
+        l = LevelCounters();
+}
+
+StatsSnapshot Stats::capture(uint64_t ops) {
+    StatsSnapshot s;
+    s.when = std::chrono::steady_clock::now();
+    s.ops = ops;
+    std::copy(levels, levels + MAX_LEVELS, s.levels);
+    return s;
+}
+
+void Stats::reportInterval(const StatsSnapshot& from, const StatsSnapshot& to) {
+    double seconds = std::chrono::duration<double>(to.when - from.when).count();
+    uint64_t ops = to.ops - from.ops;
+    std::streamsize precision = std::cout.precision();
+
+    std::cout << "[" << from.ops << ", " << to.ops << ") "
+              << std::fixed << std::setprecision(0) << (seconds > 0 ? ops / seconds : 0.0) << " ops/s";
+    std::cout << std::setprecision(2);
+    for (int l = 0; l < MAX_LEVELS; l++) {
+        LevelCounters delta;
+        delta.hits = to.levels[l].hits - from.levels[l].hits;
+        delta.misses = to.levels[l].misses - from.levels[l].misses;
+        if (delta.total())
+            std::cout << ", L" << l + 1 << " " << delta.hitRate() << "%";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision) << "\n";
+}
+
+void Stats::reportHierarchy(const std::vector<std::unique_ptr<Cache>>& caches) {
+    std::cout << "\n===== Cache Statistics =====\n";
+    for (int l = 0; l < MAX_LEVELS && l < static_cast<int>(caches.size()); l++) {
+        if (!caches[l])
+            continue;
+        std::cout << "L" << l + 1 << " Cache Hits: " << levels[l].hits << std::endl;
+        std::cout << "L" << l + 1 << " Cache Misses: " << levels[l].misses << std::endl;
+        std::cout << "L" << l + 1 << " Hit Rate: " << levels[l].hitRate() << "%" << std::endl;
+    }
+    std::cout << "==============================\n";
+}
+
+void Stats::reportSets(const Cache& cache, size_t top) {
+    const std::vector<SetCounters>& sets = cache.getSetCounters();
+    if (sets.empty())
+        return;
+
+    // Miss spread across sets: a uniform stream gives max/mean near 1, a
+    // conflict-bound one concentrates misses in a few sets
+    uint64_t total_misses = 0, max_misses = 0;
+    size_t idle = 0;
+    for (const SetCounters& s : sets) {
+        total_misses += s.misses;
+        max_misses = std::max(max_misses, s.misses);
+        idle += s.hits + s.misses == 0;
+    }
+    double mean = static_cast<double>(total_misses) / sets.size();
+    double var = 0.0;
+    for (const SetCounters& s : sets)
+        var += (s.misses - mean) * (s.misses - mean);
+    double cv = mean > 0 ? std::sqrt(var / sets.size()) / mean : 0.0;
+
+    std::vector<size_t> order(sets.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    top = std::min(top, order.size());
+    std::partial_sort(order.begin(), order.begin() + top, order.end(),
+                      [&](size_t a, size_t b) { return sets[a].misses > sets[b].misses; });
+
+    std::streamsize precision = std::cout.precision();
+    std::cout << "\n===== Per-set Statistics =====\n";
+    std::cout << "Sets: " << sets.size() << " (" << idle << " never accessed)\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Misses per set: mean " << mean << ", max " << max_misses
+              << ", max/mean " << (mean > 0 ? max_misses / mean : 0.0)
+              << ", CV " << cv << "\n";
+    std::cout << std::left << std::setw(8) << "set"
+              << std::right << std::setw(14) << "hits"
+              << std::setw(14) << "misses"
+              << std::setw(14) << "evictions"
+              << std::setw(10) << "miss %" << "\n";
+    for (size_t i = 0; i < top; i++) {
+        const SetCounters& s = sets[order[i]];
+        uint64_t total = s.hits + s.misses;
+        std::cout << std::left << std::setw(8) << order[i]
+                  << std::right << std::setw(14) << s.hits
+                  << std::setw(14) << s.misses
+                  << std::setw(14) << s.evictions
+                  << std::setw(10) << (total ? 100.0 * s.misses / total : 0.0) << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(precision);
+    std::cout << "==============================\n";
+}
@@ -3,12 +3,51 @@
 
 #include "memory.hpp"
 #include "cache.hpp"  // Add this include
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Hierarchy-level hits/misses as counted by simulateCacheAccess (an L1 refill
+// after an L2 hit is not counted again). 64-bit so long runs cannot wrap.
+struct LevelCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t total() const { return hits + misses; }
+    double hitRate() const { return total() ? 100.0 * hits / total() : 0.0; }
+};
+
+struct StatsSnapshot;
 
 class Stats {
 public:
+    static const int MAX_LEVELS = 3;
+
+    static LevelCounters& level(int l) { return levels[l]; }
+    static void resetLevels();
+
+    // Cheap point-in-time copy; two of them give per-interval deltas
+    static StatsSnapshot capture(uint64_t ops);
+    static void reportInterval(const StatsSnapshot& from, const StatsSnapshot& to);
+
+    static void reportHierarchy(const std::vector<std::unique_ptr<Cache>>& caches);
+    // Per-set hit/miss/eviction distribution and the `top` most-missing sets
+    static void reportSets(const Cache& cache, size_t top);
+
     static void report(const Memory& mem);
     static void reportCache(const Cache& cache);  // New function
     static void reportCombined(const Memory& mem, const Cache& cache);  // New function
+    static void reportLatency();                        // Hot-path histograms (stats --latency)
+    static void reportJson(const Memory* mem);          // Machine-readable (stats --json)
+
+private:
+    static inline LevelCounters levels[MAX_LEVELS];
+};
+
+struct StatsSnapshot {
+    std::chrono::steady_clock::time_point when;
+    uint64_t ops = 0;
+    LevelCounters levels[Stats::MAX_LEVELS];
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef TESTS_CHECK_HPP
+#define TESTS_CHECK_HPP
+
+#include <iostream>
+
+// Minimal assertion for the regression programs under tests/: a failed check
+// is reported and counted, and main() returns the count as its exit status.
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond \
+                      << std::endl;                                              \
+            checkFailures()++;                                                   \
+        }                                                                        \
+    } while (0)
+
+#endif
@@ -0,0 +1,113 @@
+// Capture shim regressions. The test runs itself as the traced program
+// (argv[1] picks a workload) under LD_PRELOAD=./libmmtrace.so, then reads
+// the trace back:
+//   exec   - malloc/free pairs around system("true") and thread churn; the
+//            exec'd shell must not truncate or zero the parent's trace
+//   _exit  - pairs, then _exit() without running destructors
+//   abort  - pairs, then abort()
+#include "check.hpp"
+#include "../trace.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+const char* TRACE = "tests/shim_test.trace";
+const int PAIRS = 1000;
+
+void pairs(int n) {
+    for (int i = 0; i < n; i++) {
+        void* volatile p = std::malloc(64 + i % 512);
+        std::free(p);
+    }
+}
+
+int workload(const std::string& mode) {
+    pairs(PAIRS);
+    if (mode == "exec") {
+        if (std::system("true") != 0)
+            return 1;
+        std::vector<std::thread> threads;
+        for (int round = 0; round < 25; round++) {
+            for (int t = 0; t < 4; t++)
+                threads.emplace_back([] { pairs(PAIRS); });
+            for (std::thread& t : threads)
+                t.join();
+            threads.clear();
+        }
+        pairs(PAIRS);
+    } else if (mode == "_exit") {
+        _exit(0);
+    } else if (mode == "abort") {
+        std::abort();
+    }
+    return 0;
+}
+
+void removeTraces() {
+    std::remove(TRACE);
+    if (DIR* dir = opendir("tests")) {
+        while (dirent* e = readdir(dir))
+            if (std::strncmp(e->d_name, "shim_test.trace.", 16) == 0)
+                std::remove((std::string("tests/") + e->d_name).c_str());
+        closedir(dir);
+    }
+}
+
+// Runs this binary traced in `mode`; returns the traced malloc/free events
+size_t runTraced(const char* self, const char* mode, size_t& zeroed) {
+    removeTraces();
+    std::string cmd = std::string("MMTRACE_FILE=") + TRACE + " LD_PRELOAD=./libmmtrace.so " +
+                      self + " " + mode + " 2>/dev/null";
+    std::system(cmd.c_str());
+
+    // Records that never got written read back as all-zero
+    zeroed = 0;
+    std::ifstream in(TRACE, std::ios::binary);
+    in.seekg(sizeof(TRACE_MAGIC));
+    TraceRecord rec;
+    while (in.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+        zeroed += rec.timestamp == 0;
+
+    std::vector<TraceEvent> events;
+    size_t count = 0;
+    if (loadTrace(TRACE, events))
+        for (const TraceEvent& ev : events)
+            count += ev.op == TraceOp::Malloc || ev.op == TraceOp::Free;
+    return count;
+}
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1)
+        return workload(argv[1]);
+
+    if (access("./libmmtrace.so", R_OK) != 0) {
+        std::cerr << "shim_test: build libmmtrace.so first (make shim)" << std::endl;
+        return 1;
+    }
+
+    size_t zeroed;
+    size_t events = runTraced(argv[0], "exec", zeroed);
+    CHECK(events >= 2 * PAIRS * (2 + 100));
+    CHECK(zeroed == 0);
+
+    events = runTraced(argv[0], "_exit", zeroed);
+    CHECK(events >= 2 * PAIRS);
+    CHECK(zeroed == 0);
+
+    events = runTraced(argv[0], "abort", zeroed);
+    CHECK(events >= 2 * PAIRS);
+    CHECK(zeroed == 0);
+
+    removeTraces();
+    std::cout << "shim_test: " << (checkFailures() ? "FAILED" : "ok") << std::endl;
+    return checkFailures();
+}
@@ -0,0 +1,144 @@
+// Corrupt snapshots must fail to load (leaving the live state alone) rather
+// than crash: oversized counts, impossible cache geometry, too many levels,
+// and a buddy free-list table of the wrong shape.
+#include "check.hpp"
+#include "../allocator.hpp"
+#include "../cache.hpp"
+#include "../memory.hpp"
+#include "../snapshot.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace {
+const char* PATH = "tests/snapshot_test.snap";
+const char MAGIC[8] = {'M', 'M', 'S', 'N', 'A', 'P', '0', '1'};
+const uint32_t VERSION = 4;
+
+// Header plus a 1 KB heap held in one free block, or `count` claimed blocks
+void putMemory(SnapshotWriter& w, uint64_t count = 1) {
+    w.putBytes(MAGIC, sizeof(MAGIC));
+    w.put<uint32_t>(VERSION);
+    w.put<uint64_t>(1024);                      // total
+    for (int i = 0; i < 6; i++)
+        w.put<uint64_t>(0);                     // request/realloc counters
+    w.put<uint64_t>(count);
+    w.put<uint64_t>(1024);                      // size
+    w.put<uint64_t>(0);                         // requested_size
+    w.put<int32_t>(-1);                         // id
+    w.put<uint32_t>(1);                         // free
+}
+
+void putCacheHeader(SnapshotWriter& w, uint64_t size, uint64_t block_size, int32_t assoc,
+                    const std::string& policy) {
+    w.put<uint64_t>(size);
+    w.put<uint64_t>(block_size);
+    w.put<int32_t>(assoc);
+    w.putString(policy);
+    w.put<uint64_t>(0);                         // hits
+    w.put<uint64_t>(0);                         // misses
+    w.put<uint64_t>(0);                         // evictions
+    w.put<int64_t>(0);                          // current_time
+}
+
+// Loads `w` over a live state and checks it was rejected without touching it
+bool rejected(const SnapshotWriter& w) {
+    if (!w.writeFile(PATH))
+        return false;
+    std::unique_ptr<Memory> mem = std::make_unique<Memory>(4096);
+    Memory* before = mem.get();
+    std::unique_ptr<Allocator> alloc;
+    std::vector<std::unique_ptr<Cache>> caches;
+    std::vector<int64_t> counters;
+    bool loaded = Snapshot::load(PATH, mem, alloc, caches, counters, 5);
+    std::remove(PATH);
+    return !loaded && mem.get() == before;
+}
+}
+
+int main() {
+    {
+        // count * sizeof(record) overflows to a small number
+        SnapshotWriter w;
+        putMemory(w, (1ULL << 61) + 1);
+        CHECK(rejected(w));
+    }
+    {
+        SnapshotWriter w;
+        putMemory(w);
+        w.put<uint8_t>(0);                      // no allocator
+        w.put<uint32_t>(0xFFFFFFFF);            // cache levels
+        CHECK(rejected(w));
+    }
+    {
+        // 64-byte cache, 64-byte blocks, 4 ways: zero sets
+        SnapshotWriter w;
+        putMemory(w);
+        w.put<uint8_t>(0);
+        w.put<uint32_t>(1);
+        w.put<uint8_t>(1);
+        putCacheHeader(w, 64, 64, 4, "LRU");
+        CHECK(rejected(w));
+    }
+    {
+        SnapshotWriter w;
+        putMemory(w);
+        w.put<uint8_t>(0);
+        w.put<uint32_t>(1);
+        w.put<uint8_t>(1);
+        putCacheHeader(w, 4096, 64, 4, "NOT_A_POLICY");
+        CHECK(rejected(w));
+    }
+    {
+        // A cache far larger than the file could hold lines for
+        SnapshotWriter w;
+        putMemory(w);
+        w.put<uint8_t>(0);
+        w.put<uint32_t>(1);
+        w.put<uint8_t>(1);
+        putCacheHeader(w, 1ULL << 50, 64, 4, "LRU");
+        CHECK(rejected(w));
+    }
+    {
+        SnapshotWriter w;
+        putMemory(w);
+        w.put<uint8_t>(1);
+        w.putString("buddy");
+        w.put<uint64_t>(1024);                  // mem_size
+        w.put<uint32_t>(0x7FFFFFFF);            // orders
+        CHECK(rejected(w));
+    }
+    {
+        SnapshotWriter w;
+        putMemory(w);
+        w.put<uint8_t>(1);
+        w.putString("buddy");
+        w.put<uint64_t>(1024);
+        w.put<uint32_t>(11);                    // log2(1024) + 1 orders
+        w.put<uint64_t>(1ULL << 60);            // blocks in order 0
+        CHECK(rejected(w));
+    }
+
+    // A real snapshot still round-trips
+    {
+        Memory mem(1024);
+        std::unique_ptr<Allocator> alloc = createAllocator("buddy", 1024);
+        alloc->allocate(mem, 100, 1);
+        std::vector<std::unique_ptr<Cache>> caches;
+        caches.push_back(std::make_unique<Cache>(4096, 64, 4, "LRU"));
+        CHECK(Snapshot::save(PATH, mem, alloc.get(), caches, {1, 2, 3, 4, 5}));
+
+        std::unique_ptr<Memory> loaded_mem;
+        std::unique_ptr<Allocator> loaded_alloc;
+        std::vector<std::unique_ptr<Cache>> loaded_caches;
+        std::vector<int64_t> counters;
+        CHECK(Snapshot::load(PATH, loaded_mem, loaded_alloc, loaded_caches, counters, 5));
+        CHECK(loaded_mem && loaded_mem->getTotalSize() == 1024);
+        CHECK(loaded_caches.size() == 1 && loaded_caches[0]);
+        CHECK(counters.size() == 5 && counters[4] == 5);
+        std::remove(PATH);
+    }
+
+    std::cout << "snapshot_test: " << (checkFailures() ? "FAILED" : "ok") << std::endl;
+    return checkFailures();
+}
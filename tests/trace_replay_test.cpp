@@ -0,0 +1,49 @@
+// A CLI script names blocks the way the CLI does, counting only allocations
+// that succeed. Replaying a script in which an allocation fails must free
+// and resize the same blocks the typed commands would.
+#include "check.hpp"
+#include "../compare.hpp"
+#include "../trace.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+const char* PATH = "tests/trace_replay_test.trace";
+}
+
+int main() {
+    {
+        std::ofstream out(PATH);
+        out << "malloc 600\n"           // id 1
+            << "malloc 600\n"           // Fails in a 1 KB heap, gets no id
+            << "malloc 100\n"           // id 2
+            << "free 2\n"
+            << "realloc 1 300\n";
+    }
+
+    std::vector<TraceEvent> trace;
+    CHECK(loadTrace(PATH, trace));
+    CHECK(trace.size() == 5);
+
+    std::vector<CompareResult> results = runComparison(trace, {"first_fit"}, {1024}, 1);
+    CHECK(results.size() == 1);
+    if (results.size() == 1) {
+        const CompareResult& r = results[0];
+        CHECK(r.valid);
+        CHECK(r.mallocs == 3);
+        CHECK(r.failures == 1);
+        CHECK(r.used == 300);           // Block 2 freed, block 1 shrunk
+    }
+
+    // With room for everything, ids follow the script order as before
+    results = runComparison(trace, {"first_fit"}, {2048}, 1);
+    CHECK(results.size() == 1 && results[0].failures == 0);
+    CHECK(results.size() == 1 && results[0].used == 300 + 100);
+
+    std::remove(PATH);
+    if (checkFailures() == 0)
+        std::cout << "trace_replay_test: ok" << std::endl;
+    return checkFailures();
+}
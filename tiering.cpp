@@ -0,0 +1,265 @@
+#include "tiering.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+const uint64_t HOT_THRESHOLD = 2;       // Minimum decayed heat worth promoting
+const uint64_t HYSTERESIS = 2;          // Promote only over victims this many times colder
+const size_t LINE_SIZE = 64;            // Migration copies pages line by line
+
+const struct {
+    const char* name;
+    TierPolicy policy;
+} POLICIES[] = {
+    {"fast_first", TierPolicy::FastFirst},
+    {"slow_first", TierPolicy::SlowFirst},
+    {"small_fast", TierPolicy::SmallFast},
+    {"interleave", TierPolicy::Interleave},
+};
+
+// Byte offset of live block `id` inside its Memory
+bool locate(const Memory& mem, int id, size_t& offset) {
+    offset = 0;
+    for (const Block* curr = mem.getHead(); curr; curr = curr->next) {
+        if (!curr->free && curr->id == id)
+            return true;
+        offset += curr->size;
+    }
+    return false;
+}
+}
+
+bool parseTierPolicy(const std::string& name, TierPolicy& policy) {
+    for (const auto& p : POLICIES) {
+        if (name == p.name) {
+            policy = p.policy;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* tierPolicyName(TierPolicy policy) {
+    for (const auto& p : POLICIES)
+        if (p.policy == policy)
+            return p.name;
+    return "fast_first";
+}
+
+TieredMemory::TieredMemory(const TierConfig& cfg) : config(cfg) {
+    if (config.page_size == 0)
+        config.page_size = 4096;
+    if (config.epoch == 0)
+        config.epoch = 1;
+
+    size_t sizes[2] = {config.fast_size, config.slow_size};
+    for (int t = FAST; t <= SLOW; t++) {
+        mem[t] = std::make_unique<Memory>(sizes[t]);
+        // Placement and migration find objects in the Memory block list
+        alloc[t] = createAllocator(config.allocator, sizes[t]);
+        if (!alloc[t] || !alloc[t]->ownsMemoryBlocks())
+            alloc[t] = createAllocator("first_fit", sizes[t]);
+    }
+    config.allocator = alloc[FAST]->name();
+}
+
+void TieredMemory::addCacheTraffic(const StatsSnapshot& from, const StatsSnapshot& to) {
+    for (int l = 0; l < 2; l++) {
+        cache_traffic[l].hits += to.levels[l].hits - from.levels[l].hits;
+        cache_traffic[l].misses += to.levels[l].misses - from.levels[l].misses;
+    }
+}
+
+bool TieredMemory::place(int id, size_t size, int tier) {
+    size_t offset;
+    if (!alloc[tier]->allocate(*mem[tier], size, id) || !locate(*mem[tier], id, offset))
+        return false;
+    objects[id] = {tier, offset, size, 0};
+    by_address[base(tier) + offset] = id;
+    return true;
+}
+
+int TieredMemory::allocate(size_t size, int id) {
+    if (size == 0 || objects.count(id))
+        return -1;
+
+    int first = FAST;
+    switch (config.policy) {
+        case TierPolicy::FastFirst:
+            first = FAST;
+            break;
+        case TierPolicy::SlowFirst:
+            first = SLOW;
+            break;
+        case TierPolicy::SmallFast:
+            first = size <= config.page_size ? FAST : SLOW;
+            break;
+        case TierPolicy::Interleave:
+            first = interleave_next_slow ? SLOW : FAST;
+            interleave_next_slow = !interleave_next_slow;
+            break;
+    }
+
+    if (place(id, size, first))
+        return first;
+    if (place(id, size, 1 - first))
+        return 1 - first;
+    return -1;
+}
+
+bool TieredMemory::deallocate(int id) {
+    auto it = objects.find(id);
+    if (it == objects.end())
+        return false;
+    mem[it->second.tier]->deallocate(id);
+    by_address.erase(base(it->second.tier) + it->second.offset);
+    objects.erase(it);
+    return true;
+}
+
+int TieredMemory::tierOf(int id) const {
+    auto it = objects.find(id);
+    return it == objects.end() ? -1 : it->second.tier;
+}
+
+uint64_t TieredMemory::addressOf(int id, size_t offset) const {
+    auto it = objects.find(id);
+    if (it == objects.end())
+        return 0;
+    return base(it->second.tier) + it->second.offset + std::min(offset, it->second.size - 1);
+}
+
+// Allocates the copy on the target tier before releasing the source, so a
+// failed move leaves the object where it was
+bool TieredMemory::move(int id, int tier) {
+    Placement old = objects[id];
+    size_t offset;
+    if (!alloc[tier]->allocate(*mem[tier], old.size, id))
+        return false;
+    if (!locate(*mem[tier], id, offset)) {
+        mem[tier]->deallocate(id);
+        return false;
+    }
+    mem[old.tier]->deallocate(id);
+    by_address.erase(base(old.tier) + old.offset);
+    objects[id] = {tier, offset, old.size, old.heat};
+    by_address[base(tier) + offset] = id;
+    return true;
+}
+
+void TieredMemory::onMemoryAccess(uint64_t address) {
+    auto it = by_address.upper_bound(address);
+    if (it == by_address.begin()) {
+        untracked++;
+        return;
+    }
+    --it;
+    Placement& p = objects[it->second];
+    if (address >= it->first + p.size) {
+        untracked++;
+        return;
+    }
+    p.heat++;
+    accesses[p.tier]++;
+    if (++since_epoch >= config.epoch)
+        migrate();
+}
+
+void TieredMemory::migrate() {
+    epochs++;
+    since_epoch = 0;
+
+    std::vector<std::pair<uint64_t, int>> hot, cold;   // (heat, id)
+    for (const auto& [id, p] : objects) {
+        if (p.tier == SLOW && p.heat >= HOT_THRESHOLD)
+            hot.push_back({p.heat, id});
+        else if (p.tier == FAST)
+            cold.push_back({p.heat, id});
+    }
+    std::sort(hot.begin(), hot.end(), std::greater<>());
+    std::sort(cold.begin(), cold.end());
+
+    size_t budget = config.epoch_pages;
+    size_t next_cold = 0;
+    for (const auto& [heat, id] : hot) {
+        size_t need = pages(objects[id].size);
+        if (need > budget)
+            break;
+
+        // Demote clearly colder fast objects until the promotion fits; the
+        // margin keeps objects near the boundary from bouncing every epoch
+        bool moved = move(id, FAST);
+        while (!moved && next_cold < cold.size() && cold[next_cold].first * HYSTERESIS < heat) {
+            int victim = cold[next_cold++].second;
+            size_t victim_pages = pages(objects[victim].size);
+            if (victim_pages + need > budget)
+                break;
+            if (!move(victim, SLOW)) {
+                migration_failures++;       // Slow tier full or too fragmented
+                break;
+            }
+            demoted++;
+            demoted_pages += victim_pages;
+            budget -= victim_pages;
+            moved = move(id, FAST);
+        }
+        if (!moved)
+            break;      // Out of budget or of colder victims
+
+        promoted++;
+        promoted_pages += need;
+        budget -= need;
+    }
+
+    for (auto& entry : objects)
+        entry.second.heat >>= 1;
+}
+
+void TieredMemory::report() const {
+    const LevelCounters& l1 = cache_traffic[0];
+    const LevelCounters& l2 = cache_traffic[1];
+
+    // Every reference pays L1; L1 misses pay L2 (if present); memory accesses
+    // pay their tier. Misses outside tiered objects belong to neither tier, so
+    // they get no tier share and no memory latency.
+    uint64_t memory = accesses[FAST] + accesses[SLOW];
+    uint64_t references = l1.total() ? l1.total() : memory;
+    double ns = l1.total() * config.l1_ns + l2.total() * config.l2_ns
+              + accesses[FAST] * config.fast_ns + accesses[SLOW] * config.slow_ns;
+    uint64_t moved_pages = promoted_pages + demoted_pages;
+    double migration_ns = moved_pages * (config.page_size / LINE_SIZE) * (config.fast_ns + config.slow_ns);
+
+    size_t in_tier[2] = {0, 0};
+    for (const auto& entry : objects)
+        in_tier[entry.second.tier]++;
+
+    std::streamsize precision = std::cout.precision();
+    std::cout << "\n===== Memory Tiering =====\n";
+    std::cout << "Policy: " << tierPolicyName(config.policy) << ", allocator " << alloc[FAST]->name()
+              << ", page " << config.page_size << " B, epoch " << config.epoch << " accesses\n";
+    const char* names[2] = {"Fast", "Slow"};
+    double latency[2] = {config.fast_ns, config.slow_ns};
+    for (int t = FAST; t <= SLOW; t++) {
+        std::cout << names[t] << " tier: " << mem[t]->getUsedSize() << " / " << mem[t]->getTotalSize()
+                  << " bytes, " << in_tier[t] << " objects, " << latency[t] << " ns, "
+                  << accesses[t] << " accesses\n";
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Memory accesses served by fast tier: "
+              << (memory ? 100.0 * accesses[FAST] / memory : 0.0) << "%\n";
+    if (untracked)
+        std::cout << "Memory accesses outside tiered objects: " << untracked << " (not counted)\n";
+    std::cout << "Migration passes: " << epochs << "\n";
+    std::cout << "Promoted: " << promoted << " objects (" << promoted_pages << " pages)\n";
+    std::cout << "Demoted: " << demoted << " objects (" << demoted_pages << " pages)\n";
+    std::cout << "Migration traffic: " << moved_pages * config.page_size / 1024.0 << " KB";
+    if (migration_failures)
+        std::cout << ", " << migration_failures << " blocked by fragmentation or capacity";
+    std::cout << "\n";
+    std::cout << "AMAT: " << (references ? ns / references : 0.0) << " ns"
+              << " (with migration copies: " << (references ? (ns + migration_ns) / references : 0.0) << " ns)\n";
+    std::cout << std::defaultfloat << std::setprecision(precision);
+    std::cout << "==============================\n";
+}
@@ -0,0 +1,103 @@
+#ifndef TIERING_HPP
+#define TIERING_HPP
+
+#include "memory.hpp"
+#include "allocator.hpp"
+#include "stats.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Initial placement of a new object
+enum class TierPolicy {
+    FastFirst,      // Fast tier while it has room, then slow
+    SlowFirst,      // Everything starts slow; promotion pulls hot data up
+    SmallFast,      // Objects up to one page go fast, larger ones slow
+    Interleave      // Alternate tiers per allocation
+};
+
+bool parseTierPolicy(const std::string& name, TierPolicy& policy);
+const char* tierPolicyName(TierPolicy policy);
+
+struct TierConfig {
+    size_t fast_size = 1 << 20;
+    size_t slow_size = 8 << 20;
+    double fast_ns = 80.0;          // DRAM-like
+    double slow_ns = 300.0;         // CXL / persistent-memory-like
+    double l1_ns = 1.0;             // Cache hit latencies used for AMAT
+    double l2_ns = 4.0;
+    size_t page_size = 4096;
+    uint64_t epoch = 10000;         // Memory accesses between migration passes
+    size_t epoch_pages = 256;       // Migration budget per pass (pages)
+    TierPolicy policy = TierPolicy::FastFirst;
+    std::string allocator = "first_fit";    // Allocators that keep blocks outside Memory are replaced by first_fit
+};
+
+// A fast and a slow tier, each its own Memory + Allocator. Objects live
+// wholly in one tier and are addressed at FAST_BASE / SLOW_BASE + offset, so
+// the cache simulator's miss stream (memory accesses) can be attributed back
+// to objects. Every `epoch` memory accesses the migration engine promotes the
+// hottest slow objects, demoting colder fast ones to make room, then halves
+// all heat counters. Migration moves whole objects; traffic is counted in
+// pages.
+class TieredMemory {
+public:
+    static const int FAST = 0;
+    static const int SLOW = 1;
+    static const uint64_t FAST_BASE = 1ULL << 40;
+    static const uint64_t SLOW_BASE = 2ULL << 40;
+
+    explicit TieredMemory(const TierConfig& config);
+
+    // Returns the tier used, or -1 if neither tier has room
+    int allocate(size_t size, int id);
+    bool deallocate(int id);
+    // FAST or SLOW, or -1 if `id` is not a tiered object
+    int tierOf(int id) const;
+    // Simulated address of byte `offset` of object `id` (0 if unknown)
+    uint64_t addressOf(int id, size_t offset) const;
+
+    // Feed of accesses that missed every cache level
+    void onMemoryAccess(uint64_t address);
+    // Cache traffic of one tier command (two Stats::capture() points), for AMAT
+    void addCacheTraffic(const StatsSnapshot& from, const StatsSnapshot& to);
+    void migrate();
+
+    void report() const;
+    const TierConfig& getConfig() const { return config; }
+    uint64_t getMemoryAccesses(int tier) const { return accesses[tier]; }
+    uint64_t getEpochs() const { return epochs; }
+    size_t getObjectCount() const { return objects.size(); }
+
+private:
+    struct Placement {
+        int tier;
+        size_t offset;
+        size_t size;
+        uint64_t heat;      // Memory accesses, halved every epoch
+    };
+
+    TierConfig config;
+    std::unique_ptr<Memory> mem[2];
+    std::unique_ptr<Allocator> alloc[2];
+    std::unordered_map<int, Placement> objects;
+    std::map<uint64_t, int> by_address;     // Start address -> object id
+    bool interleave_next_slow = false;
+
+    uint64_t accesses[2] = {0, 0};          // Memory accesses served per tier
+    uint64_t untracked = 0;                 // Misses outside any tiered object (not charged)
+    uint64_t since_epoch = 0;
+    uint64_t epochs = 0;
+    uint64_t promoted = 0, demoted = 0;     // Objects
+    uint64_t promoted_pages = 0, demoted_pages = 0;
+    uint64_t migration_failures = 0;
+    LevelCounters cache_traffic[2];         // L1/L2 counts from tier commands only
+
+    uint64_t base(int tier) const { return tier == FAST ? FAST_BASE : SLOW_BASE; }
+    size_t pages(size_t size) const { return (size + config.page_size - 1) / config.page_size; }
+    bool place(int id, size_t size, int tier);
+    bool move(int id, int tier);
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+bool TraceReader::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    char magic[sizeof(TRACE_MAGIC)] = {};
+    in.read(magic, sizeof(magic));
+    binary = in && std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0;
+    if (!binary) {
+        in.clear();
+        in.seekg(0);
+        return true;
+    }
+
+    TraceRecord rec;
+    while (in.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+        records.push_back(rec);
+
+    // Per-thread buffers are flushed independently; restore global order
+    std::stable_sort(records.begin(), records.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) { return a.timestamp < b.timestamp; });
+    return true;
+}
+
+size_t TraceReader::read(std::vector<TraceEvent>& out, size_t max) {
+    size_t before = out.size();
+    if (binary) {
+        while (record_pos < records.size() && out.size() - before < max)
+            decodeRecord(records[record_pos++], out);
+    } else {
+        std::string line;
+        while (out.size() - before < max && std::getline(in, line))
+            decodeLine(line, out);
+    }
+    return out.size() - before;
+}
+
+// Maps live process pointers to simulator ids. Frees of pointers that were
+// allocated before capture started are dropped.
+void TraceReader::decodeRecord(const TraceRecord& r, std::vector<TraceEvent>& out) {
+    auto allocate = [&](uint64_t ptr, uint64_t size, uint64_t align) {
+        if (!ptr)
+            return;
+        live[ptr] = next_id;
+        if (align)
+            out.push_back({TraceOp::AlignedMalloc, next_id++, size, align});
+        else
+            out.push_back({TraceOp::Malloc, next_id++, size});
+    };
+    auto release = [&](uint64_t ptr) {
+        auto it = live.find(ptr);
+        if (it == live.end())
+            return;
+        out.push_back({TraceOp::Free, it->second, 0});
+        live.erase(it);
+    };
+
+    switch (r.op) {
+        case TRACE_REC_MALLOC:
+        case TRACE_REC_CALLOC:
+            allocate(r.ptr, r.size, 0);
+            break;
+        case TRACE_REC_MEMALIGN:
+            allocate(r.ptr, r.size, r.old_ptr);
+            break;
+        case TRACE_REC_FREE:
+            release(r.ptr);
+            break;
+        case TRACE_REC_REALLOC_FROM: {
+            auto it = live.find(r.old_ptr);
+            if (it != live.end()) {
+                moving[r.tid] = it->second;
+                live.erase(it);
+            }
+            break;
+        }
+        case TRACE_REC_REALLOC_TO: {
+            auto mv = moving.find(r.tid);
+            if (mv == moving.end()) {
+                allocate(r.ptr, r.size, 0);         // Block allocated before capture
+            } else {
+                live[r.ptr] = mv->second;
+                out.push_back({TraceOp::Realloc, mv->second, r.size});
+                moving.erase(mv);
+            }
+            break;
+        }
+        case TRACE_REC_REALLOC: {
+            auto it = live.find(r.old_ptr);
+            if (r.size == 0 && !r.ptr) {
+                release(r.old_ptr);             // realloc(p, 0) frees
+            } else if (!r.ptr) {
+                // Failed realloc keeps the old block
+            } else if (it == live.end()) {
+                allocate(r.ptr, r.size, 0);     // realloc(NULL, n) or unknown block
+            } else {
+                int id = it->second;
+                live.erase(it);
+                live[r.ptr] = id;
+                out.push_back({TraceOp::Realloc, id, r.size});
+            }
+            break;
+        }
+    }
+}
+
+void TraceReader::decodeLine(const std::string& line, std::vector<TraceEvent>& out) {
+    std::istringstream iss(line);
+    std::string cmd;
+    if (!(iss >> cmd) || cmd[0] == '#')
+        return;
+
+    if (cmd == "malloc") {
+        uint64_t size;
+        if (iss >> size)
+            out.push_back({TraceOp::Malloc, 0, size});
+    } else if (cmd == "free") {
+        int id;
+        if (iss >> id)
+            out.push_back({TraceOp::Free, id, 0});
+    } else if (cmd == "realloc") {
+        int id;
+        uint64_t size;
+        if (iss >> id >> size)
+            out.push_back({TraceOp::Realloc, id, size});
+    } else if (cmd == "memalign") {
+        uint64_t align, size;
+        if (iss >> align >> size)
+            out.push_back({TraceOp::AlignedMalloc, 0, size, align});
+    }
+}
+
+bool loadTrace(const std::string& path, std::vector<TraceEvent>& events) {
+    TraceReader reader;
+    if (!reader.open(path))
+        return false;
+
+    events.clear();
+    while (reader.read(events, 1 << 16))
+        ;
+    return true;
+}
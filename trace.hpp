@@ -0,0 +1,102 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class TraceOp : uint8_t {
+    Malloc,
+    Free,
+    Realloc,
+    AlignedMalloc
+};
+
+// Pre-decoded trace event. Binary captures give every allocation its own
+// id, starting at 1. A CLI script's mallocs carry id 0: the CLI numbers only
+// allocations that succeed, so which block a later "free <id>" names is known
+// only at replay time (see TraceIdMap).
+struct TraceEvent {
+    TraceOp op;
+    int id;
+    uint64_t size;
+    uint64_t align = 0;     // AlignedMalloc only
+};
+
+// Trace id -> simulator block id for one replay. Allocations that fail are
+// never recorded, so frees and reallocs of them are dropped.
+class TraceIdMap {
+public:
+    // Records that the allocation `ev` succeeded as simulator block `block_id`
+    void allocated(const TraceEvent& ev, int block_id) { ids[ev.id ? ev.id : script_next++] = block_id; }
+    // Simulator block a free/realloc refers to, or -1 if there is none
+    int find(const TraceEvent& ev) const {
+        auto it = ids.find(ev.id);
+        return it == ids.end() ? -1 : it->second;
+    }
+    void erase(const TraceEvent& ev) { ids.erase(ev.id); }
+
+private:
+    std::unordered_map<int, int> ids;
+    int script_next = 1;    // CLI id of the next script malloc that succeeds
+};
+
+// Binary capture format written by the LD_PRELOAD shim (libmmtrace.so):
+// an 8-byte magic followed by fixed-size records. Records from different
+// threads are flushed out of order and are re-sequenced by timestamp.
+static const char TRACE_MAGIC[8] = {'M', 'M', 'T', 'R', 'A', 'C', 'E', '1'};
+
+enum TraceRecordOp : uint8_t {
+    TRACE_REC_MALLOC,
+    TRACE_REC_FREE,
+    TRACE_REC_REALLOC,
+    TRACE_REC_CALLOC,
+    TRACE_REC_MEMALIGN,     // old_ptr holds the alignment
+    // A realloc that moved the block is split in two, so each pointer is
+    // ordered correctly against other threads: old_ptr is released at call
+    // entry (FROM), and the new pointer is acquired at return (TO)
+    TRACE_REC_REALLOC_FROM,
+    TRACE_REC_REALLOC_TO
+};
+
+struct TraceRecord {
+    uint64_t timestamp;     // TSC, taken after malloc returns / before free runs
+    uint64_t ptr;           // Returned pointer, or the pointer being freed
+    uint64_t old_ptr;       // realloc input pointer
+    uint64_t size;          // Requested bytes (calloc: nmemb * size)
+    uint32_t tid;
+    uint8_t op;
+    uint8_t pad[3];
+};
+
+// Reads either a CLI script ("malloc <size>", "free <id>", "realloc <id>
+// <size>", "memalign <align> <size>"; other commands
+// and '#' comments are skipped) or a binary capture, detected by its magic.
+// Returns false if the file cannot be opened.
+bool loadTrace(const std::string& path, std::vector<TraceEvent>& events);
+
+// Incremental form of loadTrace(), so decoding can overlap with replay. A
+// binary capture is read and re-sequenced when opened; turning its records
+// into events still happens batch by batch.
+class TraceReader {
+public:
+    bool open(const std::string& path);
+    // Appends up to `max` events; returns how many (0 at end of trace)
+    size_t read(std::vector<TraceEvent>& out, size_t max);
+
+private:
+    std::ifstream in;
+    bool binary = false;
+    std::vector<TraceRecord> records;
+    size_t record_pos = 0;
+    std::unordered_map<uint64_t, int> live;     // Binary: process pointer -> id
+    std::unordered_map<uint32_t, int> moving;   // Binary: tid -> id of a realloc in flight
+    int next_id = 1;                            // Binary only
+
+    void decodeRecord(const TraceRecord& r, std::vector<TraceEvent>& out);
+    void decodeLine(const std::string& line, std::vector<TraceEvent>& out);
+};
+
+#endif
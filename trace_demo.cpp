@@ -0,0 +1,59 @@
+// Stand-in "service" for exercising libmmtrace.so: a few worker threads
+// handle request-scoped allocations of mixed sizes, with some long-lived
+// cache-line aligned objects and reallocs to grow buffers.
+//
+//   MMTRACE_FILE=demo.trace LD_PRELOAD=./libmmtrace.so ./trace_demo.exe 4 20000
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Keeps the compiler from eliding malloc/free pairs that never escape
+static void* volatile sink;
+
+static void worker(unsigned seed, int requests) {
+    static const size_t sizes[] = {16, 32, 48, 64, 128, 256, 1024, 4096};
+    std::vector<void*> cache;
+
+    for (int r = 0; r < requests; r++) {
+        seed = seed * 1103515245u + 12345u;
+        char* buf = static_cast<char*>(std::malloc(sizes[seed % 8]));
+        std::memset(buf, 0, sizes[seed % 8]);
+        sink = buf;
+
+        // Grow a response buffer a couple of times
+        char* resp = static_cast<char*>(std::calloc(1, 64));
+        resp = static_cast<char*>(std::realloc(resp, 256));
+        resp = static_cast<char*>(std::realloc(resp, 1024));
+
+        if ((seed >> 8) % 16 == 0) {
+            void* entry = nullptr;
+            if (posix_memalign(&entry, 64, 512) == 0)
+                cache.push_back(entry);
+        }
+        if (cache.size() > 64) {
+            std::free(cache.front());
+            cache.erase(cache.begin());
+        }
+
+        std::free(resp);
+        std::free(buf);
+    }
+    for (void* p : cache)
+        std::free(p);
+}
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : 4;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 10000;
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++)
+        pool.emplace_back(worker, 17u + t, requests);
+    for (auto& t : pool)
+        t.join();
+
+    std::printf("Handled %d requests on %d threads\n", threads * requests, threads);
+    return 0;
+}
@@ -0,0 +1,414 @@
+// LD_PRELOAD interposer that captures malloc/free/realloc/calloc (and the
+// aligned variants: posix_memalign, aligned_alloc, memalign) from a real
+// process into the simulator's binary trace format.
+//
+//   make shim
+//   MMTRACE_FILE=app.trace LD_PRELOAD=./libmmtrace.so ./app
+//   echo "trace replay app.trace" | ./simulator.exe
+//
+// Each thread appends fixed-size records to its own single-producer ring; a
+// background thread drains every ring and writes them with write(2). The
+// hot path is a TLS lookup, a TSC read and one release store. A ring is
+// handed back when its thread exits and reused once drained.
+//
+// The first traced process owns MMTRACE_FILE and records its pid in
+// MMTRACE_OWNER. A forked child starts over with its own file
+// (MMTRACE_FILE.<pid>) and flusher on its first event; so does an exec'd
+// descendant that inherits the variables. No process ever truncates a file
+// another pid is writing. Rings are flushed on exit(),
+// _exit()/_Exit() and fatal signals (not SIGKILL). Linux/glibc only: the real
+// allocator is reached through the __libc_* entry points, so no dlsym
+// bootstrap is needed.
+#include "trace.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void __libc_free(void* ptr);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_calloc(size_t nmemb, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace {
+const size_t RING_SIZE = 4096;      // Records per thread (power of two)
+const size_t MAX_THREADS = 128;      // Live threads; rings of exited threads are reused
+
+enum RingState : uint32_t {
+    RING_FREE,
+    RING_OWNED,
+    RING_RETIRED        // Owner exited; reusable once the flusher drained it
+};
+
+struct alignas(64) Ring {
+    std::atomic<uint64_t> head{0};  // Written by the owning thread only
+    std::atomic<uint32_t> state{RING_FREE};
+    char pad0[64 - sizeof(std::atomic<uint64_t>) - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint64_t> tail{0};  // Written by the flusher only
+    char pad1[64 - sizeof(std::atomic<uint64_t>)];
+    TraceRecord slots[RING_SIZE];
+};
+
+Ring rings[MAX_THREADS];
+std::atomic<size_t> rings_claimed{0};   // High-water mark of rings ever used
+std::atomic<uint64_t> dropped{0};
+std::atomic<bool> active{false};
+std::atomic<bool> stopping{false};
+std::atomic<bool> restart_pending{false};   // Forked child: start tracing on its first event
+std::atomic<bool> flusher_done{false};
+std::atomic<bool> stopped{false};
+int trace_fd = -1;
+char trace_path[4096];
+pthread_t flusher;
+pthread_key_t ring_key;
+bool have_ring_key = false;
+
+// initial-exec TLS never allocates, so it is safe inside malloc itself
+__attribute__((tls_model("initial-exec"))) thread_local Ring* my_ring = nullptr;
+__attribute__((tls_model("initial-exec"))) thread_local bool in_hook = false;
+__attribute__((tls_model("initial-exec"))) thread_local bool ring_failed = false;
+__attribute__((tls_model("initial-exec"))) thread_local uint32_t my_tid = 0;
+
+// Thread-exit destructor for ring_key
+void releaseRing(void* ring) {
+    my_ring = nullptr;
+    static_cast<Ring*>(ring)->state.store(RING_RETIRED, std::memory_order_release);
+}
+
+Ring* claimRing() {
+    if (ring_failed)
+        return nullptr;
+
+    // Prefer a ring whose thread has exited and whose records are all written
+    Ring* ring = nullptr;
+    size_t count = rings_claimed.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count && i < MAX_THREADS && !ring; i++) {
+        uint32_t expected = RING_RETIRED;
+        if (rings[i].state.load(std::memory_order_acquire) == RING_RETIRED &&
+            rings[i].tail.load(std::memory_order_acquire) == rings[i].head.load(std::memory_order_relaxed) &&
+            rings[i].state.compare_exchange_strong(expected, RING_OWNED, std::memory_order_acq_rel))
+            ring = &rings[i];
+    }
+    if (!ring) {
+        size_t idx = rings_claimed.fetch_add(1, std::memory_order_acq_rel);
+        if (idx >= MAX_THREADS) {
+            ring_failed = true;
+            return nullptr;
+        }
+        ring = &rings[idx];
+        ring->state.store(RING_OWNED, std::memory_order_relaxed);
+    }
+
+    // pthread_setspecific may allocate; that allocation is not traced
+    if (have_ring_key) {
+        in_hook = true;
+        pthread_setspecific(ring_key, ring);
+        in_hook = false;
+    }
+    return my_ring = ring;
+}
+
+void restartTrace();
+
+void record(uint8_t op, void* ptr, void* old_ptr, size_t size, uint64_t timestamp = 0) {
+    if (in_hook)
+        return;
+    if (!active.load(std::memory_order_relaxed)) {
+        if (!restart_pending.load(std::memory_order_relaxed) || !restart_pending.exchange(false))
+            return;
+        restartTrace();
+        if (!active.load(std::memory_order_relaxed))
+            return;
+    }
+    Ring* ring = my_ring ? my_ring : claimRing();
+    if (!ring) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    // Full ring: wait for the flusher rather than lose events
+    while (head - ring->tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        if (stopping.load(std::memory_order_relaxed)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        sched_yield();
+    }
+
+    TraceRecord& r = ring->slots[head & (RING_SIZE - 1)];
+    r.timestamp = timestamp ? timestamp : __rdtsc();
+    r.ptr = reinterpret_cast<uint64_t>(ptr);
+    r.old_ptr = reinterpret_cast<uint64_t>(old_ptr);
+    r.size = size;
+    if (!my_tid)
+        my_tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    r.tid = my_tid;
+    r.op = op;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void writeAll(const void* data, size_t n) {
+    const char* p = static_cast<const char*>(data);
+    while (n > 0) {
+        ssize_t w = ::write(trace_fd, p, n);
+        if (w <= 0)
+            return;
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+}
+
+// Copies everything published so far out of each ring; returns records moved
+size_t drain() {
+    size_t moved = 0;
+    size_t count = rings_claimed.load(std::memory_order_acquire);
+    if (count > MAX_THREADS)
+        count = MAX_THREADS;
+
+    for (size_t i = 0; i < count; i++) {
+        Ring& ring = rings[i];
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        while (tail < head) {
+            // Contiguous run up to the wrap point
+            size_t start = tail & (RING_SIZE - 1);
+            size_t n = static_cast<size_t>(head - tail);
+            if (n > RING_SIZE - start)
+                n = RING_SIZE - start;
+            writeAll(&ring.slots[start], n * sizeof(TraceRecord));
+            tail += n;
+            moved += n;
+            ring.tail.store(tail, std::memory_order_release);
+        }
+    }
+    return moved;
+}
+
+const int FATAL_SIGNALS[] = {SIGABRT, SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGTERM, SIGINT, SIGHUP, SIGQUIT};
+
+void* flushLoop(void*) {
+    in_hook = true;     // Never trace the flusher's own activity
+
+    // Fatal signals are handled on other threads, which then drain the rings
+    // themselves once this loop has exited
+    sigset_t fatal;
+    sigemptyset(&fatal);
+    for (int sig : FATAL_SIGNALS)
+        sigaddset(&fatal, sig);
+    pthread_sigmask(SIG_BLOCK, &fatal, nullptr);
+
+    const timespec idle = {0, 1000000};
+    while (!stopping.load(std::memory_order_acquire)) {
+        if (drain() == 0)
+            nanosleep(&idle, nullptr);
+    }
+    flusher_done.store(true, std::memory_order_release);
+    return nullptr;
+}
+
+// Truncates only when `truncate` (a file this pid created for this run);
+// otherwise appends, writing the header only to an empty file
+void openTrace(const char* path, bool truncate) {
+    trace_fd = ::open(path, O_WRONLY | O_CREAT | (truncate ? O_TRUNC : O_APPEND), 0644);
+    if (trace_fd >= 0) {
+        if (truncate || lseek(trace_fd, 0, SEEK_END) == 0)
+            writeAll(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        flusher_done.store(false, std::memory_order_relaxed);
+        stopped.store(false, std::memory_order_relaxed);
+        if (pthread_create(&flusher, nullptr, flushLoop, nullptr) == 0)
+            active.store(true, std::memory_order_release);
+    }
+}
+
+// Stops the flusher, writes whatever is left and closes the file. Runs once
+// per trace, from the destructor, _exit() or a fatal signal.
+void finishTrace(bool from_signal) {
+    if (!active.load() || stopped.exchange(true))
+        return;
+    in_hook = true;
+    stopping.store(true, std::memory_order_release);
+    if (from_signal) {
+        // pthread_join is not async-signal-safe; the flusher never runs this
+        // handler (it blocks the signals), so waiting for its flag is safe
+        const timespec tick = {0, 1000000};
+        for (int i = 0; i < 1000 && !flusher_done.load(std::memory_order_acquire); i++)
+            nanosleep(&tick, nullptr);
+        if (!flusher_done.load(std::memory_order_acquire))
+            return;     // Flusher stuck; writing concurrently would corrupt the file
+    } else {
+        pthread_join(flusher, nullptr);
+    }
+    active.store(false);
+    drain();
+    ::close(trace_fd);
+    if (dropped.load())
+        dprintf(STDERR_FILENO, "mmtrace: %llu events dropped\n",
+                static_cast<unsigned long long>(dropped.load()));
+}
+
+// Flushes, then lets the signal take its default action
+void onFatalSignal(int sig) {
+    finishTrace(true);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+// Only signals still at their default disposition: an inherited SIG_IGN or
+// a handler the program installs later takes precedence
+void installSignalFlush() {
+    for (int sig : FATAL_SIGNALS) {
+        struct sigaction old;
+        if (sigaction(sig, nullptr, &old) != 0 || old.sa_handler != SIG_DFL)
+            continue;
+        struct sigaction sa;
+        std::memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = onFatalSignal;
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESETHAND;
+        sigaction(sig, &sa, nullptr);
+    }
+}
+
+// A child forked without exec has no flusher, and its rings hold copies of
+// records the parent still writes. It drops those, and on its first event
+// (so fork + exec leaves no file behind) traces into its own file with a new
+// flusher; otherwise a full ring would block it forever.
+void restartInChild() {
+    active.store(false, std::memory_order_relaxed);
+    for (Ring& ring : rings) {
+        ring.head.store(0, std::memory_order_relaxed);
+        ring.tail.store(0, std::memory_order_relaxed);
+        ring.state.store(RING_FREE, std::memory_order_relaxed);
+    }
+    rings_claimed.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    my_ring = nullptr;
+    ring_failed = false;
+    if (have_ring_key)
+        pthread_setspecific(ring_key, nullptr);
+    ::close(trace_fd);
+    trace_fd = -1;
+    stopping.store(false, std::memory_order_relaxed);
+    restart_pending.store(true, std::memory_order_relaxed);
+}
+
+void restartTrace() {
+    in_hook = true;
+    char path[sizeof(trace_path) + 16];
+    snprintf(path, sizeof(path), "%s.%d", trace_path, static_cast<int>(getpid()));
+    openTrace(path, true);
+    in_hook = false;
+}
+
+__attribute__((constructor)) void startCapture() {
+    in_hook = true;
+    const char* path = getenv("MMTRACE_FILE");
+    snprintf(trace_path, sizeof(trace_path), "%s", path ? path : "mmtrace.bin");
+    have_ring_key = pthread_key_create(&ring_key, releaseRing) == 0;
+
+    // No owner yet: this process starts the capture. Owned by this pid: it
+    // exec'd itself, so keep what the old image wrote. Owned by another pid:
+    // an exec'd descendant, which (like a forked child) opens a file of its
+    // own on its first event.
+    char pid[16];
+    snprintf(pid, sizeof(pid), "%d", static_cast<int>(getpid()));
+    const char* owner = getenv("MMTRACE_OWNER");
+    if (!owner) {
+        setenv("MMTRACE_OWNER", pid, 1);
+        openTrace(trace_path, true);
+    } else if (std::strcmp(owner, pid) == 0) {
+        openTrace(trace_path, false);
+    } else {
+        restart_pending.store(true, std::memory_order_relaxed);
+    }
+    if (active.load() || restart_pending.load()) {
+        pthread_atfork(nullptr, nullptr, restartInChild);
+        installSignalFlush();
+    }
+    in_hook = false;
+}
+
+__attribute__((destructor)) void stopCapture() {
+    finishTrace(false);
+}
+}
+
+extern "C" {
+void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    record(TRACE_REC_MALLOC, p, nullptr, size);
+    return p;
+}
+
+void free(void* ptr) {
+    if (ptr)
+        record(TRACE_REC_FREE, ptr, nullptr, 0);
+    __libc_free(ptr);
+}
+
+// Releases are stamped before the real call and acquisitions after it: once
+// libc frees `ptr`, another thread may get it back from malloc, and the new
+// block may have been freed by another thread just before the call
+void* realloc(void* ptr, size_t size) {
+    uint64_t entry = __rdtsc();
+    void* p = __libc_realloc(ptr, size);
+    if (ptr && p && p != ptr) {
+        record(TRACE_REC_REALLOC_FROM, nullptr, ptr, size, entry);
+        record(TRACE_REC_REALLOC_TO, p, ptr, size);
+    } else {
+        // In place, failed, realloc(p, 0) (release) or realloc(NULL, n) (acquire)
+        record(TRACE_REC_REALLOC, p, ptr, size, ptr ? entry : 0);
+    }
+    return p;
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    void* p = __libc_calloc(nmemb, size);
+    record(TRACE_REC_CALLOC, p, nullptr, nmemb * size);
+    return p;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* p = __libc_memalign(alignment, size);
+    record(TRACE_REC_MEMALIGN, p, reinterpret_cast<void*>(alignment), size);
+    return p;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+// exit() runs the destructor; these skip it, so flush here
+void _exit(int status) {
+    finishTrace(false);
+    syscall(SYS_exit_group, status);
+    __builtin_unreachable();
+}
+
+void _Exit(int status) {
+    _exit(status);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void* p = memalign(alignment, size);
+    if (!p)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+}
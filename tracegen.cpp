@@ -0,0 +1,261 @@
+#include "tracegen.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+const size_t BATCH = 1024;
+const uint32_t MAX_CHASE_NODES = 1u << 20;     // 4 MB successor table
+
+const struct {
+    const char* name;
+    TraceModel model;
+} MODELS[] = {
+    {"uniform", TraceModel::Uniform},
+    {"sequential", TraceModel::Sequential},
+    {"strided", TraceModel::Strided},
+    {"zipf", TraceModel::Zipf},
+    {"chase", TraceModel::PointerChase},
+    {"mixed", TraceModel::Mixed},
+};
+
+// 32-bit integer finalizer (bijective); 32-bit multiplies keep batches
+// vectorizable on SSE4.1/AVX2
+inline uint32_t mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Counter-based draw: the i-th random word of stream `key`
+inline uint32_t drawAt(uint64_t i, uint32_t key) {
+    return mix32(static_cast<uint32_t>(i) ^ mix32(key ^ static_cast<uint32_t>(i >> 32)));
+}
+
+// Maps a uniform 32-bit word onto [0, n) without a division
+inline uint32_t below(uint32_t u, uint32_t n) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(u) * n) >> 32);
+}
+}
+
+bool parseTraceModel(const std::string& name, TraceModel& model) {
+    for (const auto& m : MODELS) {
+        if (name == m.name) {
+            model = m.model;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* traceModelName(TraceModel model) {
+    for (const auto& m : MODELS)
+        if (m.model == model)
+            return m.name;
+    return "uniform";
+}
+
+TraceGenerator::TraceGenerator(const TraceGenConfig& cfg) : config(cfg) {
+    if (config.block_size == 0)
+        config.block_size = 64;
+    uint64_t n = config.footprint / config.block_size;
+    blocks = static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(n, 1), UINT32_MAX));
+
+    uint64_t span = static_cast<uint64_t>(blocks) * config.block_size;
+    config.stride %= span;
+    if (config.stride == 0)
+        config.stride = config.block_size;
+
+    switch (config.model) {
+        case TraceModel::Zipf:
+            buildZipf();
+            break;
+        case TraceModel::PointerChase:
+            buildChase();
+            break;
+        case TraceModel::Mixed: {
+            const TraceModel order[] = {TraceModel::Sequential, TraceModel::Zipf, TraceModel::Strided,
+                                        TraceModel::PointerChase, TraceModel::Uniform};
+            for (size_t p = 0; p < sizeof(order) / sizeof(order[0]); p++) {
+                TraceGenConfig sub = config;
+                sub.model = order[p];
+                sub.seed = config.seed + p + 1;
+                phases.push_back(std::make_unique<TraceGenerator>(sub));
+            }
+            if (config.phase_length == 0)
+                config.phase_length = 1;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Vose's alias method: O(1) per draw with two random words and one lookup
+void TraceGenerator::buildZipf() {
+    uint32_t n = static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(config.hot_blocks, 1), blocks));
+    std::vector<double> p(n);
+    double sum = 0.0;
+    for (uint32_t r = 0; r < n; r++)
+        sum += p[r] = 1.0 / std::pow(r + 1.0, config.zipf_alpha);
+
+    std::vector<uint32_t> small, large;
+    for (uint32_t r = 0; r < n; r++) {
+        p[r] = p[r] * n / sum;
+        (p[r] < 1.0 ? small : large).push_back(r);
+    }
+
+    keep.assign(n, UINT32_MAX);
+    alias.resize(n);
+    for (uint32_t r = 0; r < n; r++)
+        alias[r] = r;
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        keep[s] = static_cast<uint32_t>(p[s] * 4294967296.0);
+        alias[s] = l;
+        p[l] -= 1.0 - p[s];
+        if (p[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+}
+
+// Sattolo's shuffle yields a single cycle, so the walk visits every node
+void TraceGenerator::buildChase() {
+    uint32_t n = std::min(blocks, MAX_CHASE_NODES);
+    node_spacing = blocks / n;
+    chase.resize(n);
+    for (uint32_t i = 0; i < n; i++)
+        chase[i] = i;
+    std::mt19937_64 gen(config.seed);
+    for (uint32_t i = n - 1; i > 0; i--)
+        std::swap(chase[i], chase[gen() % i]);
+}
+
+void TraceGenerator::fill(uint64_t* out, size_t n) {
+    const uint64_t base = config.base;
+    const uint64_t block = config.block_size;
+    const uint32_t key = static_cast<uint32_t>(config.seed) ^ static_cast<uint32_t>(config.seed >> 32);
+    const uint64_t start = index;
+    index += n;
+
+    switch (config.model) {
+        case TraceModel::Uniform:
+            for (size_t k = 0; k < n; k++)
+                out[k] = base + below(drawAt(start + k, key), blocks) * block;
+            break;
+
+        case TraceModel::Zipf: {
+            const uint32_t ranks = static_cast<uint32_t>(keep.size());
+            const uint32_t* keep_p = keep.data();
+            const uint32_t* alias_p = alias.data();
+            for (size_t k = 0; k < n; k++) {
+                uint32_t r = below(drawAt(start + k, key), ranks);
+                uint32_t coin = drawAt(start + k, ~key);
+                out[k] = base + (coin < keep_p[r] ? r : alias_p[r]) * block;
+            }
+            break;
+        }
+
+        case TraceModel::Sequential:
+        case TraceModel::Strided: {
+            const uint64_t span = static_cast<uint64_t>(blocks) * block;
+            const uint64_t step = config.model == TraceModel::Sequential ? block : config.stride;
+            uint64_t pos = offset;
+            for (size_t k = 0; k < n; k++) {
+                out[k] = base + pos;
+                pos += step;
+                pos -= pos >= span ? span : 0;
+            }
+            offset = pos;
+            break;
+        }
+
+        case TraceModel::PointerChase: {
+            // Jitter within each node's slot so power-of-two spacing does
+            // not confine the walk to a fraction of the cache sets
+            uint32_t cur = node;
+            for (size_t k = 0; k < n; k++) {
+                uint64_t jitter = node_spacing > 1 ? mix32(cur ^ key) % node_spacing : 0;
+                out[k] = base + (cur * node_spacing + jitter) * block;
+                cur = chase[cur];
+            }
+            node = cur;
+            break;
+        }
+
+        case TraceModel::Mixed:
+            while (n > 0) {
+                size_t take = static_cast<size_t>(std::min<uint64_t>(n, config.phase_length - phase_used));
+                phases[phase]->generate(out, take);
+                out += take;
+                n -= take;
+                phase_used += take;
+                if (phase_used == config.phase_length) {
+                    phase = (phase + 1) % phases.size();
+                    phase_used = 0;
+                }
+            }
+            break;
+    }
+}
+
+void TraceGenerator::generate(uint64_t* out, size_t n) {
+    // Hand out whatever next() already buffered first
+    size_t buffered = std::min(n, buffer.size() - buffer_pos);
+    std::copy(buffer.begin() + buffer_pos, buffer.begin() + buffer_pos + buffered, out);
+    buffer_pos += buffered;
+    if (n > buffered)
+        fill(out + buffered, n - buffered);
+}
+
+uint64_t TraceGenerator::next() {
+    if (buffer_pos == buffer.size()) {
+        buffer.resize(BATCH);
+        fill(buffer.data(), BATCH);
+        buffer_pos = 0;
+    }
+    return buffer[buffer_pos++];
+}
+
+void TraceGenerator::skip(uint64_t n) {
+    uint64_t buffered = std::min<uint64_t>(n, buffer.size() - buffer_pos);
+    buffer_pos += buffered;
+    n -= buffered;
+    if (n == 0)
+        return;
+    index += n;
+
+    switch (config.model) {
+        case TraceModel::Sequential:
+        case TraceModel::Strided: {
+            uint64_t span = static_cast<uint64_t>(blocks) * config.block_size;
+            uint64_t step = config.model == TraceModel::Sequential ? config.block_size : config.stride;
+            offset = static_cast<uint64_t>((offset + static_cast<unsigned __int128>(n) * step) % span);
+            break;
+        }
+        case TraceModel::PointerChase:
+            for (uint64_t i = n % chase.size(); i > 0; i--)
+                node = chase[node];
+            break;
+        case TraceModel::Mixed:
+            while (n > 0) {
+                uint64_t take = std::min(n, config.phase_length - phase_used);
+                phases[phase]->skip(take);
+                n -= take;
+                phase_used += take;
+                if (phase_used == config.phase_length) {
+                    phase = (phase + 1) % phases.size();
+                    phase_used = 0;
+                }
+            }
+            break;
+        default:
+            break;      // Counter-based: advancing the index is enough
+    }
+}
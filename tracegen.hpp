@@ -0,0 +1,75 @@
+#ifndef TRACEGEN_HPP
+#define TRACEGEN_HPP
+
+#include "sampling.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class TraceModel {
+    Uniform,        // Independent block-aligned addresses over the footprint
+    Sequential,     // Streams through the footprint one block at a time
+    Strided,        // Streams with a fixed byte stride
+    Zipf,           // Zipfian popularity over a hot set of blocks
+    PointerChase,   // Walks a random cyclic permutation of nodes
+    Mixed           // Cycles through the models above, phase_length accesses each
+};
+
+struct TraceGenConfig {
+    TraceModel model = TraceModel::Uniform;
+    uint64_t base = 0;
+    uint64_t footprint = 1 << 20;   // Bytes covered by the stream
+    uint64_t block_size = 64;
+    uint64_t stride = 256;          // Strided only
+    double zipf_alpha = 0.99;
+    uint64_t hot_blocks = 1 << 16;  // Zipf: distinct blocks ranked by popularity
+    uint64_t phase_length = 100000; // Mixed only
+    uint64_t seed = 1;
+};
+
+// Name as typed at the CLI (uniform, sequential, strided, zipf, chase, mixed)
+bool parseTraceModel(const std::string& name, TraceModel& model);
+const char* traceModelName(TraceModel model);
+
+// Seeded, reproducible 64-bit address streams. Uniform and Zipf addresses
+// are a pure function of (seed, index), so a batch has no loop-carried
+// dependency and skip() is O(1); sequential and strided skips are also O(1).
+// At most 2^32 blocks of the footprint are addressable.
+class TraceGenerator : public AddressSource {
+public:
+    explicit TraceGenerator(const TraceGenConfig& config);
+
+    // Writes the next n addresses of the stream
+    void generate(uint64_t* out, size_t n) override;
+
+    uint64_t next() override;
+    void skip(uint64_t n) override;
+
+    const TraceGenConfig& getConfig() const { return config; }
+
+private:
+    TraceGenConfig config;
+    uint32_t blocks;
+    uint64_t index = 0;             // Accesses produced (or skipped) so far
+    uint64_t offset = 0;            // Sequential/strided position in bytes
+    uint32_t node = 0;              // Pointer-chase position
+
+    // Zipf alias table: rank r keeps itself with probability keep[r] / 2^32
+    std::vector<uint32_t> keep, alias;
+    std::vector<uint32_t> chase;    // Successor of each node
+    uint64_t node_spacing = 1;      // Blocks between pointer-chase nodes
+
+    std::vector<std::unique_ptr<TraceGenerator>> phases;
+    uint64_t phase_used = 0;        // Accesses taken from the current phase
+    size_t phase = 0;
+
+    std::vector<uint64_t> buffer;   // Serves next() a batch at a time
+    size_t buffer_pos = 0;
+
+    void fill(uint64_t* out, size_t n);
+    void buildZipf();
+    void buildChase();
+};
+
+#endif
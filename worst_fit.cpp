@@ -1,7 +1,17 @@
 #include "allocator.hpp"
 
+static Block* largerBlock(Block* a, Block* b) {
+    return (a->size > b->size) ? a : b;
+}
+
 Block* WorstFit::allocate(Memory& mem, size_t size, int id) {
-    return mem.allocateWithSelect(size, id, [](Block* a, Block* b) {
-        return (a->size > b->size) ? a : b;
-    });
+    return mem.allocateWithSelect(size, id, largerBlock);
+}
+
+Block* WorstFit::reallocate(Memory& mem, int id, size_t size) {
+    return mem.reallocate(id, size, largerBlock);
+}
+
+Block* WorstFit::allocateAligned(Memory& mem, size_t size, size_t align, int id) {
+    return mem.allocateAligned(size, align, id, largerBlock);
 }
\ No newline at end of file